@@ -24,6 +24,7 @@ GameClient::GameClient() {
     SetWindowMinSize(800, 600);
 
     netClient = ENetClient::alloc();
+    master.onP2PSignal = [this](const P2PSignalPacket& sig) { OnP2PSignal(sig); };
 
     float scale = GetUIScale();
     GuiSetStyle(DEFAULT, TEXT_SIZE, (int)(20 * scale));
@@ -51,18 +52,7 @@ void GameClient::ConnectToLobby(const std::string& ip, int port, uint32_t lobbyI
     relayLobbyId = lobbyId;
 
     TraceLog(LOG_INFO, ">> Requesting P2P hole punch via Master Server...");
-
-    if (!netClient->isConnected()) {
-        ClientConfig& cfg = ConfigManager::GetClient();
-        netClient->connect(cfg.masterServerIp, cfg.masterServerPort);
-    }
-
-    Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-    ser.value1b(GamePacket::P2P_REQUEST);
-    P2PRequestPacket req; req.lobbyId = lobbyId;
-    ser.object(req); ser.adapter().flush();
-
-    netClient->send(DeliveryType::RELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
+    master.RequestP2P(lobbyId);
 }
 
 void GameClient::SendGamePacket(DeliveryType type, StreamBuffer::Shared stream) {
@@ -145,6 +135,32 @@ void GameClient::StartP2PPunch(const std::string& targetIp, uint16_t targetPort)
         std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
 }
+void GameClient::OnP2PSignal(const P2PSignalPacket& sig) {
+    std::string finalIp = sig.publicIp;
+    if (sig.publicIp == sig.yourIp) {
+        finalIp = "127.0.0.1";
+        TraceLog(LOG_INFO, ">> P2P: Same network detected, using 127.0.0.1");
+    }
+
+    // The master saw our public endpoint on its own connection, so the game connection
+    // has to go out through that same socket for the punched hole to match
+    if (!sig.isHost) netClient = master.DetachConnection();
+
+    ENetClient::Shared client = netClient;
+    std::thread([this, sig, finalIp, client]() {
+        this->StartP2PPunch(sig.publicIp, sig.publicPort);
+
+        if (!sig.isHost) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(400));
+            TraceLog(LOG_INFO, ">> P2P: Connecting to %s:%d", finalIp.c_str(), sig.publicPort);
+
+            client->disconnect();
+            std::this_thread::sleep_for(std::chrono::milliseconds(100));
+            client->connect(finalIp, sig.publicPort);
+        }
+        }).detach();
+}
+
 void GameClient::Run() {
     ChangeScene(std::make_shared<MainMenuScene>(this));
 
@@ -158,11 +174,14 @@ void GameClient::Run() {
 
         float dt = GetFrameTime();
 
+        master.Update(dt);
+
         if (netClient) {
             auto msgs = netClient->poll();
             for (auto& msg : msgs) {
                 if (msg->type() == MessageType::CONNECT) {
                     TraceLog(LOG_INFO, ">> CLIENT: Connected to %s", useRelay ? "Relay" : "Host Directly");
+                    relayDecoder.Reset();
 
                     if (!useRelay) {
                         Buffer buffer; OutputAdapter adapter(buffer);
@@ -186,39 +205,18 @@ void GameClient::Run() {
                     bitsery::Deserializer<InputAdapter> des(std::move(ia));
                     uint8_t pktType; des.value1b(pktType);
 
-                    if (pktType == GamePacket::P2P_SIGNAL) {
-                        P2PSignalPacket sig;
-                        des.object(sig);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-
-                            std::string finalIp = sig.publicIp;
-                            if (sig.publicIp == sig.yourIp) {
-                                finalIp = "127.0.0.1";
-                                TraceLog(LOG_INFO, ">> P2P: Same network detected, using 127.0.0.1");
-                            }
-
-                            std::thread([this, sig, finalIp]() {
-                                this->StartP2PPunch(sig.publicIp, sig.publicPort);
-
-                                if (!sig.isHost) {
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(400));
-                                    TraceLog(LOG_INFO, ">> P2P: Connecting to %s:%d", finalIp.c_str(), sig.publicPort);
-
-                                    this->netClient->disconnect();
-                                    std::this_thread::sleep_for(std::chrono::milliseconds(100));
-                                    this->netClient->connect(finalIp, sig.publicPort);
-                                }
-                                }).detach();
-                        }
-                        continue;
-                    }
-
                     if (useRelay && pktType == GamePacket::RELAY_TO_CLIENT) {
                         RelayPacket rp;
                         des.object(rp);
 
                         if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            if (rp.isCompressed) {
+                            if (rp.compression == RelayCompression::STREAM) {
+                                std::vector<uint8_t> decompressed;
+                                // Undecodable deltas are expected after a lost keyframe; treat them as lost
+                                if (!relayDecoder.Decode(rp.data, decompressed)) continue;
+                                payload = StreamBuffer::alloc(decompressed.data(), decompressed.size());
+                            }
+                            else if (rp.compression == RelayCompression::BLOCK) {
                                 std::vector<uint8_t> decompressed = CompressionHelper::Decompress(rp.data);
                                 if (!decompressed.empty()) {
                                     payload = StreamBuffer::alloc(decompressed.data(), decompressed.size());
@@ -4,6 +4,8 @@
 #include "../engine/Scenes/Scene.h"
 #include "../engine/ServerHost.h"
 #include "AudioManager.h"
+#include "MasterClient.h"
+#include "common/RelayStreamCompression.h"
 #include <memory>
 
 class Scene;
@@ -14,6 +16,7 @@ public:
     int screenHeight = 720;
 
     ENetClient::Shared netClient;
+    MasterClient master;
     std::unique_ptr<ServerHost> localServer;
     AudioManager audio;
 
@@ -22,6 +25,7 @@ public:
 
     bool useRelay = false;
     uint32_t relayLobbyId = 0;
+    RelayStreamDecoder relayDecoder;
 
     GameClient();
     ~GameClient();
@@ -41,4 +45,7 @@ public:
 
     float GetUIScale() const;
     void StartP2PPunch(const std::string& targetIp, uint16_t targetPort);
+
+private:
+    void OnP2PSignal(const P2PSignalPacket& sig);
 };
\ No newline at end of file
@@ -0,0 +1,140 @@
+﻿#include "MasterClient.h"
+#include "../engine/Utils/ConfigManager.h"
+#include "raylib.h"
+#include <algorithm>
+
+void MasterClient::Connect() {
+    if (!client) client = ENetClient::alloc();
+    ClientConfig& cfg = ConfigManager::GetClient();
+    if (client->connectAsync(cfg.masterServerIp, cfg.masterServerPort)) {
+        state = State::CONNECTING;
+    }
+    else {
+        state = State::DISCONNECTED;
+        retryDelay = std::clamp(retryDelay * 2.0f, 1.0f, MAX_RETRY_DELAY);
+        retryTimer = retryDelay;
+    }
+}
+
+void MasterClient::Send(StreamBuffer::Shared stream) {
+    if (state == State::CONNECTED && client && client->isConnected()) {
+        client->send(DeliveryType::RELIABLE, stream);
+        return;
+    }
+    pending.push_back(stream);
+    if (state == State::DISCONNECTED && retryTimer <= 0.0f) Connect();
+}
+
+void MasterClient::Update(float dt) {
+    if (refreshing) {
+        refreshTimer += dt;
+        if (refreshTimer >= REFRESH_TIMEOUT) refreshing = false;
+    }
+
+    if (state == State::DISCONNECTED) {
+        if (pending.empty()) return;
+        retryTimer -= dt;
+        if (retryTimer <= 0.0f) Connect();
+        return;
+    }
+
+    for (auto& msg : client->poll()) {
+        if (msg->type() == MessageType::CONNECT) {
+            TraceLog(LOG_INFO, ">> MASTER: Connected");
+            state = State::CONNECTED;
+            retryDelay = 0.0f;
+            for (auto& stream : pending) client->send(DeliveryType::RELIABLE, stream);
+            pending.clear();
+        }
+        else if (msg->type() == MessageType::DISCONNECT) {
+            TraceLog(LOG_WARNING, ">> MASTER: Connection %s", state == State::CONNECTING ? "failed" : "lost");
+            state = State::DISCONNECTED;
+            retryDelay = std::clamp(retryDelay * 2.0f, 1.0f, MAX_RETRY_DELAY);
+            retryTimer = retryDelay;
+            if (pending.empty()) refreshing = false;
+            break;
+        }
+        else if (msg->type() == MessageType::DATA) {
+            HandleMessage(msg->stream());
+        }
+    }
+}
+
+void MasterClient::RequestLobbyList() {
+    if (refreshing) return;
+    refreshing = true;
+    refreshTimer = 0.0f;
+    collecting.clear();
+    listRequest = MasterListReqPacket();
+    listRequest.knownVersion = lobbyListVersion;
+    SendListRequest();
+}
+
+void MasterClient::SendListRequest() {
+    Buffer buffer; OutputAdapter adapter(buffer);
+    bitsery::Serializer<OutputAdapter> serializer(std::move(adapter));
+    serializer.value1b(GamePacket::MASTER_LIST_REQ);
+    serializer.object(listRequest);
+    serializer.adapter().flush();
+    Send(StreamBuffer::alloc(buffer.data(), buffer.size()));
+}
+
+void MasterClient::RequestP2P(uint32_t lobbyId) {
+    Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+    ser.value1b(GamePacket::P2P_REQUEST);
+    P2PRequestPacket req; req.lobbyId = lobbyId;
+    ser.object(req); ser.adapter().flush();
+    Send(StreamBuffer::alloc(buf.data(), buf.size()));
+}
+
+ENetClient::Shared MasterClient::DetachConnection() {
+    ENetClient::Shared detached = client;
+    client.reset();
+    state = State::DISCONNECTED;
+    pending.clear();
+    retryTimer = 0.0f;
+    refreshing = false;
+    return detached;
+}
+
+void MasterClient::HandleMessage(StreamBuffer::Shared stream) {
+    const auto& buf = stream->buffer();
+    size_t offset = stream->tellg();
+    if (buf.empty() || offset >= buf.size()) return;
+
+    InputAdapter ia(buf.begin() + offset, buf.end());
+    bitsery::Deserializer<InputAdapter> des(std::move(ia));
+    uint8_t type; des.value1b(type);
+
+    if (type == GamePacket::MASTER_LIST_RES) {
+        MasterListResPacket res; des.object(res);
+        if (des.adapter().error() != bitsery::ReaderError::NoError || !refreshing) return;
+
+        if (res.notModified) { refreshing = false; return; }
+        if (res.page == 0) collectingVersion = res.version;
+        else if (res.version != collectingVersion) {
+            // The list changed between pages; mixing them could duplicate or skip lobbies
+            collecting.clear();
+            listRequest.knownVersion = lobbyListVersion;
+            listRequest.page = 0;
+            SendListRequest();
+            return;
+        }
+        collecting.insert(collecting.end(), res.lobbies.begin(), res.lobbies.end());
+        if (res.page + 1 < res.totalPages && res.page + 1 < MAX_LIST_PAGES) {
+            // A known version would get notModified for the remaining pages
+            listRequest.knownVersion = 0;
+            listRequest.page = res.page + 1;
+            SendListRequest();
+            return;
+        }
+        lobbies = std::move(collecting);
+        collecting.clear();
+        lobbyListVersion = res.version;
+        refreshing = false;
+    }
+    else if (type == GamePacket::P2P_SIGNAL) {
+        P2PSignalPacket sig; des.object(sig);
+        if (des.adapter().error() == bitsery::ReaderError::NoError && onP2PSignal) onP2PSignal(sig);
+    }
+}
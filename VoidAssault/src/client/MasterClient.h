@@ -0,0 +1,58 @@
+﻿#pragma once
+#include "enet/ENetClient.h"
+#include "common/NetworkPackets.h"
+#include <functional>
+#include <vector>
+
+// Persistent, non-blocking connection to the master server, driven from the main loop.
+// Requests made while disconnected are queued and sent once the connection is up;
+// a lost connection is re-established with backoff while requests are waiting.
+class MasterClient {
+public:
+    enum class State {
+        DISCONNECTED,
+        CONNECTING,
+        CONNECTED
+    };
+
+    std::function<void(const P2PSignalPacket&)> onP2PSignal;
+
+    void Update(float dt);
+
+    void RequestLobbyList();
+    void RequestP2P(uint32_t lobbyId);
+
+    State GetState() const { return state; }
+    bool IsRefreshing() const { return refreshing; }
+    const std::vector<LobbyInfo>& GetLobbies() const { return lobbies; }
+
+    // Hands the connection over, e.g. so the game connection reuses the socket the master
+    // used for P2P signaling. The next request opens a new connection.
+    ENetClient::Shared DetachConnection();
+
+private:
+    void Connect();
+    void Send(StreamBuffer::Shared stream);
+    void SendListRequest();
+    void HandleMessage(StreamBuffer::Shared stream);
+
+    ENetClient::Shared client;
+    State state = State::DISCONNECTED;
+    std::vector<StreamBuffer::Shared> pending;
+
+    float retryTimer = 0.0f;
+    float retryDelay = 0.0f;
+    const float MAX_RETRY_DELAY = 30.0f;
+
+    bool refreshing = false;
+    float refreshTimer = 0.0f;
+    const float REFRESH_TIMEOUT = 5.0f;
+    const uint16_t MAX_LIST_PAGES = 8;
+    MasterListReqPacket listRequest;
+    std::vector<LobbyInfo> collecting;
+    // Version of the first page of the refresh; later pages must come from the same list
+    uint32_t collectingVersion = 0;
+    std::vector<LobbyInfo> lobbies;
+    // Version of lobbies on the master, sent back so an unchanged list isn't resent
+    uint32_t lobbyListVersion = 0;
+};
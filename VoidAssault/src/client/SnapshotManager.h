@@ -3,6 +3,8 @@
 #include "raymath.h"
 #include <deque>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
 #include <algorithm>
 #include <cmath>
 
@@ -29,6 +31,8 @@ public:
         }
 
         history.push_back(snap);
+        if (snap.isPartial && history.size() > 1) MergePartial(history[history.size() - 2], history.back());
+        for (const auto& e : snap.entities) lastSeen[e.id] = snap.serverTime;
 
                 while (history.size() > 2 && history[0].serverTime < history.back().serverTime - 2.0) {
             history.pop_front();
@@ -93,6 +97,32 @@ public:
     }
 
 private:
+    // Server time each entity was last actually sent, to expire ones a partial snapshot never mentions again
+    std::unordered_map<uint32_t, double> lastSeen;
+    const double PARTIAL_ENTITY_TIMEOUT = 3.0;
+
+    // A partial snapshot only carries the entities the server had budget for;
+    // the rest keep their previous state until they are updated or removed.
+    void MergePartial(const WorldSnapshotPacket& prev, WorldSnapshotPacket& snap) {
+        std::unordered_set<uint32_t> present;
+        for (const auto& e : snap.entities) present.insert(e.id);
+        std::unordered_set<uint32_t> removed(snap.removedIds.begin(), snap.removedIds.end());
+
+        for (const auto& e : prev.entities) {
+            if (present.count(e.id) || removed.count(e.id)) continue;
+            auto seen = lastSeen.find(e.id);
+            if (seen == lastSeen.end() || seen->second < snap.serverTime - PARTIAL_ENTITY_TIMEOUT) continue;
+            snap.entities.push_back(e);
+        }
+        for (uint32_t id : snap.removedIds) lastSeen.erase(id);
+        if (lastSeen.size() > snap.entities.size() * 2 + 64) {
+            for (auto it = lastSeen.begin(); it != lastSeen.end();) {
+                if (it->second < snap.serverTime - PARTIAL_ENTITY_TIMEOUT) it = lastSeen.erase(it);
+                else ++it;
+            }
+        }
+    }
+
     bool FindEntityInSnapshot(const WorldSnapshotPacket& snap, uint32_t id, EntityState& out) {
         for (const auto& e : snap.entities) {
             if (e.id == id) {
@@ -30,6 +30,8 @@ void GameplayScene::Enter() {
     currentWave = 1; selectedBuildType = 0;
     std::fill(myInventory.begin(), myInventory.end(), 255);
     lastFrameEntityIds.clear(); gunAnimOffset = 0.0f;
+    myTurretCount = 0; leaderboardRows.clear();
+    minimapDirty = true; leaderboardDirty = true;
 
             if (game->useRelay) {
         snapshotManager.interpolationDelay = 0.200;
@@ -57,6 +59,7 @@ void GameplayScene::Enter() {
 }
 
 void GameplayScene::Exit() {
+    UnloadHudTextures();
     if (game->netClient) game->netClient->disconnect();
     game->StopHost();
 }
@@ -125,31 +128,55 @@ void GameplayScene::OnMessage(Message::Shared msg) {
                     break;
                 }
             }
+
+            // Partial snapshots are merged with earlier state, so count from the merged one
+            const auto& world = snapshotManager.history.back().entities;
+            myTurretCount = 0;
+            for (const auto& ent : world) {
+                if (ent.type == EntityType::TURRET && ent.ownerId == myPlayerId) myTurretCount++;
+            }
+            minimapDirty = true;
+            UpdateLeaderboardRows(world);
+
+            for (const auto& evt : snap.events.Decode()) SpawnEventEffect(evt);
         }
     }
         else if (packetTypeInt == GamePacket::STATS) {
         PlayerStatsPacket stats; deserializer.object(stats);
         if (deserializer.adapter().error() == bitsery::ReaderError::NoError) {
-            myLevel = stats.level; myCurrentXp = stats.currentXp; myMaxXp = stats.maxXp;
-            myMaxHealth = stats.maxHealth; myDamage = stats.damage; mySpeed = stats.speed;
-            myScrap = stats.scrap; myKills = stats.kills;
-            if (stats.inventory.size() == 6) myInventory = stats.inventory;
-            isAdmin = stats.isAdmin;
+            if (stats.fields & StatsField::LEVEL) myLevel = stats.level;
+            if (stats.fields & StatsField::CURRENT_XP) myCurrentXp = stats.currentXp;
+            if (stats.fields & StatsField::MAX_XP) myMaxXp = stats.maxXp;
+            if (stats.fields & StatsField::MAX_HEALTH) myMaxHealth = stats.maxHealth;
+            if (stats.fields & StatsField::DAMAGE) myDamage = stats.damage;
+            if (stats.fields & StatsField::SPEED) mySpeed = stats.speed;
+            if (stats.fields & StatsField::SCRAP) myScrap = stats.scrap;
+            if (stats.fields & StatsField::KILLS) myKills = stats.kills;
+            if ((stats.fields & StatsField::INVENTORY) && stats.inventory.size() == 6) myInventory = stats.inventory;
+            if (stats.fields & StatsField::ADMIN) isAdmin = stats.isAdmin;
         }
     }
     else if (packetTypeInt == GamePacket::EVENT) {
         EventPacket evt; deserializer.object(evt);
+        if (deserializer.adapter().error() == bitsery::ReaderError::NoError) SpawnEventEffect(evt);
+    }
+    else if (packetTypeInt == GamePacket::EVENT_BATCH) {
+        EventBatchPacket batch; deserializer.object(batch);
         if (deserializer.adapter().error() == bitsery::ReaderError::NoError) {
-            if (evt.type == 0) particles.SpawnExplosion(evt.pos, 4, evt.color);
-            else if (evt.type == 1) particles.SpawnExplosion(evt.pos, 20, evt.color);
-            else if (evt.type == 2) {
-                particles.SpawnExplosion(evt.pos, 15, evt.color);
-                for (int i = 0; i < 360; i += 20) {
-                    float ang = i * DEG2RAD;
-                    Vector2 vel = { cosf(ang) * 100.0f, sinf(ang) * 100.0f };
-                    particles.Spawn(evt.pos, vel, evt.color, 4.0f, 0.5f);
-                }
-            }
+            for (const auto& evt : batch.Decode()) SpawnEventEffect(evt);
+        }
+    }
+}
+
+void GameplayScene::SpawnEventEffect(const EventPacket& evt) {
+    if (evt.type == 0) particles.SpawnExplosion(evt.pos, 4, evt.color);
+    else if (evt.type == 1) particles.SpawnExplosion(evt.pos, 20, evt.color);
+    else if (evt.type == 2) {
+        particles.SpawnExplosion(evt.pos, 15, evt.color);
+        for (int i = 0; i < 360; i += 20) {
+            float ang = i * DEG2RAD;
+            Vector2 vel = { cosf(ang) * 100.0f, sinf(ang) * 100.0f };
+            particles.Spawn(evt.pos, vel, evt.color, 4.0f, 0.5f);
         }
     }
 }
@@ -232,6 +259,8 @@ void GameplayScene::Update(float dt) {
 
     if (pkt.isShooting && gunAnimOffset <= 1.0f) gunAnimOffset = 12.0f;
 
+    RefreshHudTextures();
+
     if (isPredictedInit) {
         Vector2 velocity = Vector2Scale(pkt.movement, currentSpeed * dt);
         Vector2 nextPos = Vector2Add(predictedPos, velocity);
@@ -401,30 +430,88 @@ void GameplayScene::Draw() {
     EndMode2D();
 }
 
-void GameplayScene::DrawLeaderboard(const std::vector<EntityState>& entities) {
-    if (!showLeaderboard) return;
-    int w = GetScreenWidth();
+void GameplayScene::UpdateLeaderboardRows(const std::vector<EntityState>& entities) {
+    std::vector<LeaderboardRow> rows;
+    for (const auto& e : entities) if (e.type == EntityType::PLAYER) rows.push_back({ e.id, e.kills, e.name });
+    std::sort(rows.begin(), rows.end(), [](const LeaderboardRow& a, const LeaderboardRow& b) {
+        return a.kills != b.kills ? a.kills > b.kills : a.id < b.id;
+        });
+    if (rows != leaderboardRows) {
+        leaderboardRows = std::move(rows);
+        leaderboardDirty = true;
+    }
+}
+
+void GameplayScene::UnloadHudTextures() {
+    if (minimapTexture.id != 0) UnloadRenderTexture(minimapTexture);
+    if (leaderboardTexture.id != 0) UnloadRenderTexture(leaderboardTexture);
+    minimapTexture = { 0 };
+    leaderboardTexture = { 0 };
+    hudTextureScale = 0.0f;
+}
+
+void GameplayScene::RefreshHudTextures() {
     float uiScale = game->GetUIScale();
+    int rowsNeeded = (int)leaderboardRows.size();
+    float boardH = 30 * uiScale + (rowsNeeded * 25.0f * uiScale);
+
+    if (uiScale != hudTextureScale) {
+        UnloadHudTextures();
+        int mapSize = (int)(150.0f * uiScale);
+        minimapTexture = LoadRenderTexture(mapSize, mapSize);
+        hudTextureScale = uiScale;
+        minimapDirty = true;
+        leaderboardDirty = true;
+    }
+    if (leaderboardTexture.id == 0 || leaderboardTexture.texture.height < (int)boardH) {
+        if (leaderboardTexture.id != 0) UnloadRenderTexture(leaderboardTexture);
+        // Grow in steps of 8 rows so joining players don't reallocate every time
+        int rowsCapacity = ((rowsNeeded / 8) + 1) * 8;
+        leaderboardTexture = LoadRenderTexture((int)(200.0f * uiScale), (int)(30 * uiScale + rowsCapacity * 25.0f * uiScale));
+        leaderboardDirty = true;
+    }
+
+    if (minimapDirty && !snapshotManager.history.empty()) {
+        RenderMinimap(snapshotManager.history.back().entities);
+        minimapDirty = false;
+    }
+    if (leaderboardDirty && showLeaderboard) {
+        RenderLeaderboard();
+        leaderboardDirty = false;
+    }
+}
+
+void GameplayScene::RenderLeaderboard() {
+    float uiScale = hudTextureScale;
     float boardW = 200.0f * uiScale;
-    float startX = w - boardW - 10;
-    float startY = 80 * uiScale;
-    std::vector<EntityState> players;
-    for (const auto& e : entities) if (e.type == EntityType::PLAYER) players.push_back(e);
-    std::sort(players.begin(), players.end(), [](const EntityState& a, const EntityState& b) { return a.kills > b.kills; });
-    float boardH = 30 * uiScale + (players.size() * 25.0f * uiScale);
-    DrawRectangle(startX, startY, boardW, boardH, Fade(BLACK, 0.5f));
-    DrawRectangleLines(startX, startY, boardW, boardH, Theme::COL_ACCENT);
-    DrawText("LEADERBOARD", startX + 10 * uiScale, startY + 5 * uiScale, 20 * uiScale, Theme::COL_ACCENT);
-    float y = startY + 30 * uiScale;
-    for (const auto& p : players) {
+    BeginTextureMode(leaderboardTexture);
+    ClearBackground(BLANK);
+    DrawText("LEADERBOARD", 10 * uiScale, 5 * uiScale, 20 * uiScale, Theme::COL_ACCENT);
+    float y = 30 * uiScale;
+    for (const auto& p : leaderboardRows) {
         bool isMe = (p.id == myPlayerId);
         Color textColor = isMe ? YELLOW : WHITE;
         std::string displayName = p.name.empty() ? TextFormat("Player %d", p.id % 100) : p.name;
-        DrawText(displayName.c_str(), startX + 10 * uiScale, y, 16 * uiScale, textColor);
+        DrawText(displayName.c_str(), 10 * uiScale, y, 16 * uiScale, textColor);
         const char* score = TextFormat("%d", p.kills);
-        DrawText(score, startX + boardW - MeasureText(score, 16 * uiScale) - 10 * uiScale, y, 16 * uiScale, textColor);
+        DrawText(score, boardW - MeasureText(score, 16 * uiScale) - 10 * uiScale, y, 16 * uiScale, textColor);
         y += 22 * uiScale;
     }
+    EndTextureMode();
+}
+
+void GameplayScene::DrawLeaderboard() {
+    if (!showLeaderboard || leaderboardTexture.id == 0) return;
+    int w = GetScreenWidth();
+    float uiScale = hudTextureScale;
+    float boardW = 200.0f * uiScale;
+    float startX = w - boardW - 10;
+    float startY = 80 * uiScale;
+    float boardH = 30 * uiScale + (leaderboardRows.size() * 25.0f * uiScale);
+    DrawRectangle(startX, startY, boardW, boardH, Fade(BLACK, 0.5f));
+    DrawRectangleLines(startX, startY, boardW, boardH, Theme::COL_ACCENT);
+    const Texture2D& tex = leaderboardTexture.texture;
+    DrawTextureRec(tex, { 0, 0, (float)tex.width, -(float)tex.height }, { startX, startY }, WHITE);
 }
 
 void GameplayScene::DrawGUI() {
@@ -432,8 +519,8 @@ void GameplayScene::DrawGUI() {
     GuiSetStyle(DEFAULT, TEXT_SIZE, (int)(20 * uiScale)); float padding = 20 * uiScale;
 
     if (!snapshotManager.history.empty()) {
-        DrawMinimap(snapshotManager.history.back().entities);
-        DrawLeaderboard(snapshotManager.history.back().entities);
+        DrawMinimap();
+        DrawLeaderboard();
     }
 
     DrawText(TextFormat("Scrap: %d", myScrap), padding, 170 * uiScale, 20 * uiScale, GOLD);
@@ -447,13 +534,6 @@ void GameplayScene::DrawGUI() {
     bY = h - 350 * uiScale; bX = w - 100 * uiScale;
 #endif
 
-    int myTurretCount = 0;
-    if (!snapshotManager.history.empty()) {
-        for (const auto& e : snapshotManager.history.back().entities) {
-            if (e.type == EntityType::TURRET && e.ownerId == myPlayerId) myTurretCount++;
-        }
-    }
-
     for (int i = 0; i < 3; i++) {
         Rectangle bRect = { bX, bY + i * (45 * uiScale), 110 * uiScale, 40 * uiScale };
         int type = i + 1;
@@ -560,16 +640,14 @@ void GameplayScene::DrawAdminPanel() {
     if (GuiButton({ panel.x + 10, y, 280 * uiScale, btnH }, "RESET SERVER")) SendAdminCmd(AdminCmdType::RESET_SERVER, 0);
 }
 
-void GameplayScene::DrawMinimap(const std::vector<EntityState>& entities) {
-    float mapSize = 150.0f * game->GetUIScale();
-    float padding = 10.0f * game->GetUIScale();
-    Vector2 mapOrigin = { padding, padding };
-    DrawRectangleV(mapOrigin, { mapSize, mapSize }, Fade(BLACK, 0.7f));
-    DrawRectangleLinesEx({ mapOrigin.x, mapOrigin.y, mapSize, mapSize }, 2, WHITE);
+void GameplayScene::RenderMinimap(const std::vector<EntityState>& entities) {
+    float mapSize = (float)minimapTexture.texture.width;
     float worldSize = 4000.0f;
     float scale = mapSize / worldSize;
+    BeginTextureMode(minimapTexture);
+    ClearBackground(BLANK);
     for (const auto& e : entities) {
-        Vector2 mapPos = { mapOrigin.x + e.position.x * scale, mapOrigin.y + e.position.y * scale };
+        Vector2 mapPos = { e.position.x * scale, e.position.y * scale };
         Color dotCol = WHITE;
         if (e.id == myPlayerId) dotCol = BLUE;
         else if (e.type == EntityType::PLAYER) dotCol = SKYBLUE;
@@ -577,4 +655,16 @@ void GameplayScene::DrawMinimap(const std::vector<EntityState>& entities) {
         else continue;
         DrawCircleV(mapPos, 2.0f, dotCol);
     }
-}
\ No newline at end of file
+    EndTextureMode();
+}
+
+void GameplayScene::DrawMinimap() {
+    if (minimapTexture.id == 0) return;
+    float mapSize = (float)minimapTexture.texture.width;
+    float padding = 10.0f * hudTextureScale;
+    Vector2 mapOrigin = { padding, padding };
+    DrawRectangleV(mapOrigin, { mapSize, mapSize }, Fade(BLACK, 0.7f));
+    const Texture2D& tex = minimapTexture.texture;
+    DrawTextureRec(tex, { 0, 0, (float)tex.width, -(float)tex.height }, mapOrigin, WHITE);
+    DrawRectangleLinesEx({ mapOrigin.x, mapOrigin.y, mapSize, mapSize }, 2, WHITE);
+}
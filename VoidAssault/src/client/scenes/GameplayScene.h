@@ -6,9 +6,19 @@
 #include "../ParticleSystem.h"
 #include <memory>
 #include <vector>
+#include <string>
 #include "Theme.h"
 
 class GameClient;
+
+struct LeaderboardRow {
+    uint32_t id = 0;
+    uint32_t kills = 0;
+    std::string name;
+
+    bool operator==(const LeaderboardRow&) const = default;
+};
+
 class GameplayScene : public Scene {
     Camera2D camera = { 0 };
 
@@ -45,6 +55,15 @@ class GameplayScene : public Scene {
 
     bool showAdminPanel = false;
     bool showLeaderboard = true;
+    int myTurretCount = 0;
+
+    // HUD layers are rendered off-screen and only redrawn when a snapshot arrives or the ranking changes
+    RenderTexture2D minimapTexture = { 0 };
+    RenderTexture2D leaderboardTexture = { 0 };
+    float hudTextureScale = 0.0f;
+    bool minimapDirty = true;
+    bool leaderboardDirty = true;
+    std::vector<LeaderboardRow> leaderboardRows;
 
 #if defined(PLATFORM_ANDROID) || defined(ANDROID)
     std::unique_ptr<VirtualJoystick> leftStick;
@@ -59,6 +78,7 @@ public:
     void Exit() override;
 
     void OnMessage(Message::Shared msg) override;
+    void SpawnEventEffect(const EventPacket& evt);
     void SendAction(const ActionPacket& act);
     void SendAdminCmd(uint8_t cmd, uint32_t val);
 
@@ -66,7 +86,12 @@ public:
     void Draw() override;
     void DrawGUI() override;
 
-    void DrawMinimap(const std::vector<EntityState>& entities);
-    void DrawLeaderboard(const std::vector<EntityState>& entities);
+    void DrawMinimap();
+    void DrawLeaderboard();
+    void RenderMinimap(const std::vector<EntityState>& entities);
+    void RenderLeaderboard();
+    void UpdateLeaderboardRows(const std::vector<EntityState>& entities);
+    void RefreshHudTextures();
+    void UnloadHudTextures();
     void DrawAdminPanel();
 };
\ No newline at end of file
@@ -50,55 +50,7 @@ void MainMenuScene::Update(float dt) {
 }
 
 void MainMenuScene::RefreshLobbyList() {
-    if (isRefreshing) return;
-    isRefreshing = true;
-
-    {
-        std::lock_guard<std::mutex> lock(lobbyMutex);
-        lobbyList.clear();
-    }
-
-    std::thread([this]() {
-                auto tempClient = ENetClient::alloc();
-        ClientConfig& cCfg = ConfigManager::GetClient();
-
-        if (tempClient->connect(cCfg.masterServerIp, cCfg.masterServerPort)) {
-            Buffer buffer; OutputAdapter adapter(buffer);
-            bitsery::Serializer<OutputAdapter> serializer(std::move(adapter));
-            serializer.value1b(GamePacket::MASTER_LIST_REQ);
-            serializer.adapter().flush();
-            tempClient->send(DeliveryType::RELIABLE, StreamBuffer::alloc(buffer.data(), buffer.size()));
-
-            auto start = std::chrono::steady_clock::now();
-            bool gotResponse = false;
-
-                        while (std::chrono::steady_clock::now() - start < std::chrono::seconds(2)) {
-                auto msgs = tempClient->poll();
-                for (auto& msg : msgs) {
-                    if (msg->type() == MessageType::DATA) {
-                        const auto& buf = msg->stream()->buffer();
-                        size_t offset = msg->stream()->tellg();
-                        if (!buf.empty() && offset < buf.size()) {
-                            InputAdapter ia(buf.begin() + offset, buf.end());
-                            bitsery::Deserializer<InputAdapter> des(std::move(ia));
-                            uint8_t type; des.value1b(type);
-                            if (type == GamePacket::MASTER_LIST_RES) {
-                                MasterListResPacket res; des.object(res);
-
-                                                                std::lock_guard<std::mutex> lock(lobbyMutex);
-                                lobbyList = res.lobbies;
-                                gotResponse = true;
-                            }
-                        }
-                    }
-                }
-                if (gotResponse) break;
-                std::this_thread::sleep_for(std::chrono::milliseconds(10));
-            }
-            tempClient->disconnect();
-        }
-        isRefreshing = false;
-        }).detach();
+    game->master.RequestLobbyList();
 }
 
 bool MainMenuScene::DrawInputField(Rectangle bounds, char* buffer, int bufferSize, bool& editMode) {
@@ -215,7 +167,7 @@ void MainMenuScene::DrawGUI() {
         contentY += fieldH + spacing;
 
                 if (activeMpTab == 0) {
-                        if (GuiButton({ contentX + contentW - 120 * uiScale, contentY, 120 * uiScale, 30 * uiScale }, isRefreshing ? "..." : ConfigManager::Text("btn_refresh"))) {
+                        if (GuiButton({ contentX + contentW - 120 * uiScale, contentY, 120 * uiScale, 30 * uiScale }, game->master.IsRefreshing() ? "..." : ConfigManager::Text("btn_refresh"))) {
                 RefreshLobbyList();
             }
             contentY += 35 * uiScale;
@@ -229,9 +181,9 @@ void MainMenuScene::DrawGUI() {
             float itemH = 40 * uiScale;
             float listMaxY = panelRect.y + panelRect.height - 60 * uiScale;
 
-                        std::lock_guard<std::mutex> lock(lobbyMutex);
+            const std::vector<LobbyInfo>& lobbyList = game->master.GetLobbies();
 
-            if (lobbyList.empty() && !isRefreshing) {
+            if (lobbyList.empty() && !game->master.IsRefreshing()) {
                 DrawTextEx(font, ConfigManager::Text("msg_no_servers"), { contentX + 10, contentY + 10 }, 20 * uiScale, 1, GRAY);
             }
 
@@ -6,7 +6,6 @@
 #include "common/enet/ENetClient.h"
 #include <string>
 #include <vector>
-#include <mutex> 
 class GameClient;
 
 enum class MenuState {
@@ -34,10 +33,7 @@ private:
     int activeMpTab = 0; 
     InGameKeyboard virtualKeyboard;
 
-        std::vector<LobbyInfo> lobbyList;
-    std::mutex lobbyMutex;     bool isRefreshing = false;
 
-    
     bool DrawInputField(Rectangle bounds, char* buffer, int bufferSize, bool& editMode);
     void RefreshLobbyList();
 
@@ -3,7 +3,7 @@
 #include <ctime>
 #include <string>
 #include <sstream>
-#include "raylib.h"
+#include "RaylibTypes.h"
 
 /**
  * Precision explicit typedefs
@@ -0,0 +1,95 @@
+﻿#pragma once
+// Minimal stand-in for the parts of raylib/raymath used by the engine and packet code,
+// so the headless server build doesn't link raylib. Layouts and values match raylib.
+#include <cmath>
+#include <cstdio>
+#include <cstdarg>
+
+#ifndef PI
+#define PI 3.14159265358979323846f
+#endif
+#ifndef DEG2RAD
+#define DEG2RAD (PI/180.0f)
+#endif
+#ifndef RAD2DEG
+#define RAD2DEG (180.0f/PI)
+#endif
+
+struct Vector2 {
+    float x;
+    float y;
+};
+
+struct Vector3 {
+    float x;
+    float y;
+    float z;
+};
+
+struct Vector4 {
+    float x;
+    float y;
+    float z;
+    float w;
+};
+
+typedef Vector4 Quaternion;
+
+struct Color {
+    unsigned char r;
+    unsigned char g;
+    unsigned char b;
+    unsigned char a;
+};
+
+#define LIGHTGRAY  Color{ 200, 200, 200, 255 }
+#define GRAY       Color{ 130, 130, 130, 255 }
+#define DARKGRAY   Color{ 80, 80, 80, 255 }
+#define YELLOW     Color{ 253, 249, 0, 255 }
+#define GOLD       Color{ 255, 203, 0, 255 }
+#define ORANGE     Color{ 255, 161, 0, 255 }
+#define RED        Color{ 230, 41, 55, 255 }
+#define GREEN      Color{ 0, 228, 48, 255 }
+#define BLUE       Color{ 0, 121, 241, 255 }
+#define PURPLE     Color{ 200, 122, 255, 255 }
+#define WHITE      Color{ 255, 255, 255, 255 }
+#define BLACK      Color{ 0, 0, 0, 255 }
+#define BLANK      Color{ 0, 0, 0, 0 }
+
+enum TraceLogLevel {
+    LOG_ALL = 0,
+    LOG_TRACE,
+    LOG_DEBUG,
+    LOG_INFO,
+    LOG_WARNING,
+    LOG_ERROR,
+    LOG_FATAL,
+    LOG_NONE
+};
+
+inline void TraceLog(int logLevel, const char* text, ...) {
+    if (logLevel < LOG_INFO) return;
+    static const char* prefixes[] = { "", "TRACE: ", "DEBUG: ", "INFO: ", "WARNING: ", "ERROR: ", "FATAL: ", "" };
+    std::fputs(prefixes[(logLevel >= 0 && logLevel <= LOG_NONE) ? logLevel : 0], stdout);
+    va_list args;
+    va_start(args, text);
+    std::vprintf(text, args);
+    va_end(args);
+    std::fputc('\n', stdout);
+}
+
+inline Vector2 Vector2Add(Vector2 v1, Vector2 v2) { return { v1.x + v2.x, v1.y + v2.y }; }
+inline Vector2 Vector2Subtract(Vector2 v1, Vector2 v2) { return { v1.x - v2.x, v1.y - v2.y }; }
+inline Vector2 Vector2Scale(Vector2 v, float scale) { return { v.x * scale, v.y * scale }; }
+inline float Vector2Length(Vector2 v) { return sqrtf(v.x * v.x + v.y * v.y); }
+inline float Vector2Distance(Vector2 v1, Vector2 v2) { return sqrtf((v1.x - v2.x) * (v1.x - v2.x) + (v1.y - v2.y) * (v1.y - v2.y)); }
+
+inline Vector2 Vector2Normalize(Vector2 v) {
+    float length = sqrtf(v.x * v.x + v.y * v.y);
+    if (length > 0) return { v.x / length, v.y / length };
+    return { 0.0f, 0.0f };
+}
+
+inline Vector2 Vector2Lerp(Vector2 v1, Vector2 v2, float amount) {
+    return { v1.x + amount * (v2.x - v1.x), v1.y + amount * (v2.y - v1.y) };
+}
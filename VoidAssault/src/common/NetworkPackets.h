@@ -1,9 +1,11 @@
 ﻿#pragma once
 #include "PacketSerialization.h"
-#include "raylib.h"
+#include "net/Message.h"
 #include <cstdint>
 #include <vector>
 #include <string>
+#include <cmath>
+#include <algorithm>
 
 namespace GamePacket {
     enum Type : uint8_t {
@@ -22,7 +24,10 @@ namespace GamePacket {
         RELAY_TO_SERVER,
         RELAY_TO_CLIENT,
         P2P_SIGNAL = 16,
-        P2P_REQUEST = 17
+        P2P_REQUEST = 17,
+        EVENT_BATCH = 18,
+        MASTER_REDIRECT = 19,
+        RELAY_MULTICAST = 20
     };
 }
 struct P2PSignalPacket {
@@ -47,21 +52,91 @@ struct P2PRequestPacket {
         s.value4b(lobbyId);
     }
 };
+namespace RelayCompression {
+    enum : uint8_t {
+        NONE = 0,
+        // Standalone block from CompressionHelper
+        BLOCK = 1,
+        // Per-session stream, see RelayStreamCompression.h
+        STREAM = 2
+    };
+}
+
+// Largest relay packet the master forwards unreliably (RelayLimits::maxPacketBytes). Hosts
+// keep all relay traffic below it; the payload limit leaves room for the packet headers.
+const size_t RELAY_MAX_PACKET_BYTES = 256 * 1024;
+const size_t RELAY_MAX_PAYLOAD_BYTES = RELAY_MAX_PACKET_BYTES - 64;
+
 struct RelayPacket {
     uint32_t targetId;
     bool isReliable;
-    bool isCompressed = false;
+    uint8_t compression = RelayCompression::NONE;
     std::vector<uint8_t> data;
 
     template <typename S>
     void serialize(S& s) {
         s.value4b(targetId);
         s.boolValue(isReliable);
-        s.boolValue(isCompressed);
+        s.value1b(compression);
 
         s.container1b(data, 1048576);
     }
 };
+// One payload for several relay clients of the same host; the master fans it out as
+// RELAY_TO_CLIENT packets so the host uplink carries it once.
+struct RelayMulticastPacket {
+    // Senders split longer target lists into several packets (ServerHost::SendRelayMulticast)
+    static constexpr size_t MAX_TARGETS = 255;
+
+    bool isReliable;
+    uint8_t compression = RelayCompression::NONE;
+    std::vector<uint32_t> targetIds;
+    std::vector<uint8_t> data;
+
+    // Targets are written with a one-byte count so the master can read them at fixed offsets.
+    // Writing never changes targetIds; only reading grows it to the received count.
+    template <typename S>
+    void serialize(S& s) {
+        s.boolValue(isReliable);
+        s.value1b(compression);
+        uint8_t count = (uint8_t)std::min(targetIds.size(), MAX_TARGETS);
+        s.value1b(count);
+        if (targetIds.size() < count) targetIds.resize(count);
+        for (size_t i = 0; i < count; i++) s.value4b(targetIds[i]);
+        s.container1b(data, 1048576);
+    }
+};
+
+// Fixed-offset view of a serialized RelayPacket inside a received Message, so relays can
+// be forwarded without deserializing the payload. Must match RelayPacket::serialize.
+namespace RelayHeader {
+    const size_t TYPE_OFFSET = Message::HEADER_SIZE;
+    const size_t TARGET_OFFSET = TYPE_OFFSET + 1;
+    const size_t RELIABLE_OFFSET = TARGET_OFFSET + 4;
+    const size_t SIZE = RELIABLE_OFFSET + 2;
+
+    inline uint32_t ReadTargetAt(const uint8_t* data, size_t offset) {
+        return (uint32_t)data[offset] | ((uint32_t)data[offset + 1] << 8) |
+            ((uint32_t)data[offset + 2] << 16) | ((uint32_t)data[offset + 3] << 24);
+    }
+
+    inline bool Parse(const uint8_t* data, size_t length, uint8_t& type, uint32_t& targetId, bool& isReliable) {
+        if (length < SIZE) return false;
+        type = data[TYPE_OFFSET];
+        targetId = ReadTargetAt(data, TARGET_OFFSET);
+        isReliable = data[RELIABLE_OFFSET] != 0;
+        return true;
+    }
+
+    inline void WriteTargetId(uint8_t* data, uint32_t targetId) {
+        for (int i = 0; i < 4; i++) data[TARGET_OFFSET + i] = (uint8_t)(targetId >> (8 * i));
+    }
+
+    // RelayMulticastPacket: type, isReliable, compression, count, count * targetId, data
+    const size_t MULTICAST_COUNT_OFFSET = TYPE_OFFSET + 3;
+    const size_t MULTICAST_TARGETS_OFFSET = MULTICAST_COUNT_OFFSET + 1;
+}
+
 namespace ActionType {
     enum : uint8_t {
         BUILD_WALL = 1,
@@ -123,6 +198,8 @@ struct LobbyInfo {
     uint8_t currentPlayers;
     uint8_t maxPlayers;
     uint8_t wave;
+    // Master shard port that relays for this lobby
+    uint16_t relayPort = 0;
 
     template <typename S>
     void serialize(S& s) {
@@ -133,6 +210,7 @@ struct LobbyInfo {
         s.value1b(currentPlayers);
         s.value1b(maxPlayers);
         s.value1b(wave);
+        s.value2b(relayPort);
     }
 };
 
@@ -149,6 +227,16 @@ struct MasterRegisterPacket {
     }
 };
 
+// Sent by the entry master shard to move a registering host to a less loaded shard
+struct MasterRedirectPacket {
+    uint16_t port;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value2b(port);
+    }
+};
+
 struct MasterHeartbeatPacket {
     uint8_t currentPlayers;
     uint8_t wave;
@@ -160,12 +248,47 @@ struct MasterHeartbeatPacket {
     }
 };
 
+// Lobby list query. knownVersion works like If-None-Match: when it equals the master's
+// current list version the response is notModified and carries no lobbies.
+struct MasterListReqPacket {
+    uint32_t knownVersion = 0;
+    uint16_t page = 0;
+    uint8_t pageSize = 50;
+    bool notFull = false;
+    std::string namePrefix;
+    uint8_t minWave = 0;
+    uint8_t maxWave = 255;
+
+    bool HasFilters() const { return notFull || !namePrefix.empty() || minWave > 0 || maxWave < 255; }
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value4b(knownVersion);
+        s.value2b(page);
+        s.value1b(pageSize);
+        s.boolValue(notFull);
+        s.text1b(namePrefix, 32);
+        s.value1b(minWave);
+        s.value1b(maxWave);
+    }
+};
+
 struct MasterListResPacket {
+    uint32_t version = 0;
+    bool notModified = false;
+    uint16_t page = 0;
+    uint16_t totalPages = 0;
+    uint32_t totalLobbies = 0;
     std::vector<LobbyInfo> lobbies;
 
     template <typename S>
     void serialize(S& s) {
-        s.container(lobbies, 100);
+        s.value4b(version);
+        s.boolValue(notModified);
+        s.value2b(page);
+        s.value2b(totalPages);
+        s.value4b(totalLobbies);
+        s.container(lobbies, 255);
     }
 };
 
@@ -192,6 +315,81 @@ struct EventPacket {
     }
 };
 
+// Fixed set of colors the server uses for gameplay effects, sent as a palette index
+namespace EventPalette {
+    static const Color COLORS[] = { WHITE, GRAY, RED, ORANGE, GREEN, GOLD };
+    static const uint8_t COUNT = sizeof(COLORS) / sizeof(COLORS[0]);
+
+    inline uint8_t IndexOf(Color c) {
+        for (uint8_t i = 0; i < COUNT; i++) {
+            if (COLORS[i].r == c.r && COLORS[i].g == c.g && COLORS[i].b == c.b && COLORS[i].a == c.a) return i;
+        }
+        return 0;
+    }
+
+    inline Color At(uint8_t index) {
+        return index < COUNT ? COLORS[index] : WHITE;
+    }
+}
+
+// One event inside an EventBatchPacket: type in the high nibble, palette index in the low nibble,
+// position as a whole-unit delta from the previous event in the batch (the first one is absolute)
+struct BatchedEvent {
+    uint8_t typeAndColor = 0;
+    int16_t dx = 0;
+    int16_t dy = 0;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value1b(typeAndColor);
+        s.value2b(dx);
+        s.value2b(dy);
+    }
+};
+
+struct EventBatchPacket {
+    static constexpr size_t MAX_EVENTS = 4096;
+
+    std::vector<BatchedEvent> events;
+
+    // Encodes at most MAX_EVENTS events from the front of src; the caller keeps the rest
+    // for the next batch
+    static EventBatchPacket Encode(const std::vector<EventPacket>& src) {
+        EventBatchPacket batch;
+        size_t count = std::min(src.size(), MAX_EVENTS);
+        batch.events.reserve(count);
+        int prevX = 0, prevY = 0;
+        for (size_t i = 0; i < count; i++) {
+            const EventPacket& evt = src[i];
+            int x = (int)roundf(evt.pos.x);
+            int y = (int)roundf(evt.pos.y);
+            BatchedEvent be;
+            be.typeAndColor = (uint8_t)((evt.type << 4) | (EventPalette::IndexOf(evt.color) & 0x0F));
+            be.dx = (int16_t)(x - prevX);
+            be.dy = (int16_t)(y - prevY);
+            batch.events.push_back(be);
+            prevX = x; prevY = y;
+        }
+        return batch;
+    }
+
+    std::vector<EventPacket> Decode() const {
+        std::vector<EventPacket> out;
+        out.reserve(events.size());
+        int x = 0, y = 0;
+        for (const auto& be : events) {
+            x += be.dx; y += be.dy;
+            out.push_back({ (uint8_t)(be.typeAndColor >> 4), { (float)x, (float)y }, EventPalette::At(be.typeAndColor & 0x0F) });
+        }
+        return out;
+    }
+
+    template <typename S>
+    void serialize(S& s) {
+        s.container(events, MAX_EVENTS);
+    }
+};
+
 struct ActionPacket {
     uint8_t type;
     Vector2 target;
@@ -212,30 +410,49 @@ struct AdminCommandPacket {
     }
 };
 
+namespace StatsField {
+    enum : uint16_t {
+        LEVEL = 1 << 0,
+        CURRENT_XP = 1 << 1,
+        MAX_XP = 1 << 2,
+        MAX_HEALTH = 1 << 3,
+        DAMAGE = 1 << 4,
+        SPEED = 1 << 5,
+        SCRAP = 1 << 6,
+        KILLS = 1 << 7,
+        INVENTORY = 1 << 8,
+        ADMIN = 1 << 9,
+        ALL = 0x03FF
+    };
+}
+
+// Only the fields flagged in `fields` are on the wire; a full refresh sets StatsField::ALL
 struct PlayerStatsPacket {
-    uint32_t level;
-    float currentXp;
-    float maxXp;
-    float maxHealth;
-    float damage;
-    float speed;
-    uint32_t scrap;
-    uint32_t kills;
+    uint16_t fields = StatsField::ALL;
+    uint32_t level = 1;
+    float currentXp = 0.0f;
+    float maxXp = 0.0f;
+    float maxHealth = 0.0f;
+    float damage = 0.0f;
+    float speed = 0.0f;
+    uint32_t scrap = 0;
+    uint32_t kills = 0;
     std::vector<uint8_t> inventory;
-    bool isAdmin;
+    bool isAdmin = false;
 
     template <typename S>
     void serialize(S& s) {
-        s.value4b(level);
-        s.value4b(currentXp);
-        s.value4b(maxXp);
-        s.value4b(maxHealth);
-        s.value4b(damage);
-        s.value4b(speed);
-        s.value4b(scrap);
-        s.value4b(kills);
-        s.container1b(inventory, 6);
-        s.boolValue(isAdmin);
+        s.value2b(fields);
+        if (fields & StatsField::LEVEL) s.value4b(level);
+        if (fields & StatsField::CURRENT_XP) s.value4b(currentXp);
+        if (fields & StatsField::MAX_XP) s.value4b(maxXp);
+        if (fields & StatsField::MAX_HEALTH) s.value4b(maxHealth);
+        if (fields & StatsField::DAMAGE) s.value4b(damage);
+        if (fields & StatsField::SPEED) s.value4b(speed);
+        if (fields & StatsField::SCRAP) s.value4b(scrap);
+        if (fields & StatsField::KILLS) s.value4b(kills);
+        if (fields & StatsField::INVENTORY) s.container1b(inventory, 6);
+        if (fields & StatsField::ADMIN) s.boolValue(isAdmin);
     }
 };
 
@@ -292,12 +509,20 @@ struct WorldSnapshotPacket {
     double serverTime;
     uint32_t wave;
     std::vector<EntityState> entities;
+    EventBatchPacket events;
+    // Partial snapshots only carry the entities that fit the client's budget;
+    // the rest keep their last known state on the client unless listed in removedIds
+    bool isPartial = false;
+    std::vector<uint32_t> removedIds;
 
     template <typename S>
     void serialize(S& s) {
         s.value8b(serverTime);
         s.value4b(wave);
         s.container(entities, 40000);
+        s.object(events);
+        s.boolValue(isPartial);
+        s.container4b(removedIds, 40000);
     }
 };
 
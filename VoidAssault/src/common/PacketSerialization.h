@@ -1,5 +1,5 @@
 ﻿#pragma once
-#include "raylib.h"
+#include "RaylibTypes.h"
 #include <vector>
 #include <cstdint>
 
@@ -0,0 +1,9 @@
+﻿#pragma once
+// Vector2/Color and the raymath helpers used by engine and packet code.
+// The headless server build (VOID_HEADLESS) gets a minimal replacement instead of raylib.
+#ifdef VOID_HEADLESS
+#include "HeadlessRaylib.h"
+#else
+#include "raylib.h"
+#include "raymath.h"
+#endif
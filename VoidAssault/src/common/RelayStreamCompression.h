@@ -0,0 +1,152 @@
+﻿#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include "lz4.h"
+
+// Per-session dictionary compression for relay payloads. Consecutive packets of a session
+// are very similar, so each one is compressed against an earlier payload the receiver
+// is guaranteed to hold:
+//  - reliable packets chain on the previous reliable payload (the channel is ordered and lossless);
+//  - unreliable packets use the payload of a keyframe as dictionary. Every KEYFRAME_INTERVAL
+//    unreliable packets a keyframe resets the dictionary and is itself sent reliably, and deltas
+//    refer to the keyframe before the newest one, so it has had time to arrive. A delta whose
+//    keyframe is missing is dropped like a lost packet and never desyncs the stream.
+namespace RelayStream {
+    enum Mode : uint8_t {
+        CHAINED = 0,
+        KEYFRAME = 1,
+        DELTA = 2
+    };
+
+    // mode (1) + epoch (1) + original size (4)
+    const size_t HEADER_SIZE = 6;
+    const size_t MAX_DICT_SIZE = 64 * 1024;
+    const uint32_t MAX_PAYLOAD_SIZE = 1048576;
+    const int KEYFRAME_INTERVAL = 32;
+
+    inline void StoreDict(std::vector<uint8_t>& dict, const std::vector<uint8_t>& payload) {
+        size_t n = std::min(payload.size(), MAX_DICT_SIZE);
+        dict.assign(payload.end() - n, payload.end());
+    }
+}
+
+class RelayStreamEncoder {
+public:
+    RelayStreamEncoder() : stream(LZ4_createStream()) {}
+    ~RelayStreamEncoder() { LZ4_freeStream(stream); }
+    RelayStreamEncoder(const RelayStreamEncoder&) = delete;
+    RelayStreamEncoder& operator=(const RelayStreamEncoder&) = delete;
+
+    void Reset() {
+        chainDict.clear();
+        keyframes[0].clear(); keyframes[1].clear();
+        epoch = 0; keyframesSent = 0; sinceKeyframe = 0;
+    }
+
+    // reliable may be switched on for keyframes, which must reach the receiver.
+    // Returns an empty vector when the payload must be sent uncompressed; the stream state
+    // is then left untouched, so the receiver's decoder stays in step.
+    // Returns an empty buffer, without touching the stream state, when the payload can't be
+    // compressed into maxSize bytes; the caller then sends it uncompressed or not at all.
+    std::vector<uint8_t> Encode(const std::vector<uint8_t>& payload, bool& reliable, size_t maxSize) {
+        // The decoder rejects anything larger, which would break the reliable chain
+        if (payload.size() > RelayStream::MAX_PAYLOAD_SIZE) return {};
+
+        if (reliable) {
+            auto out = Compress(RelayStream::CHAINED, 0, payload, chainDict);
+            if (out.empty() || out.size() > maxSize) return {};
+            RelayStream::StoreDict(chainDict, payload);
+            return out;
+        }
+
+        if (keyframesSent == 0 || sinceKeyframe >= RelayStream::KEYFRAME_INTERVAL) {
+            uint8_t nextEpoch = epoch + 1;
+            auto out = Compress(RelayStream::KEYFRAME, nextEpoch, payload, {});
+            if (out.empty() || out.size() > maxSize) return {};
+            epoch = nextEpoch;
+            keyframesSent++;
+            sinceKeyframe = 0;
+            RelayStream::StoreDict(keyframes[epoch & 1], payload);
+            reliable = true;
+            return out;
+        }
+
+        uint8_t refEpoch = (keyframesSent >= 2) ? (uint8_t)(epoch - 1) : epoch;
+        auto out = Compress(RelayStream::DELTA, refEpoch, payload, keyframes[refEpoch & 1]);
+        if (out.empty() || out.size() > maxSize) return {};
+        sinceKeyframe++;
+        return out;
+    }
+
+private:
+    std::vector<uint8_t> Compress(uint8_t mode, uint8_t refEpoch, const std::vector<uint8_t>& payload, const std::vector<uint8_t>& dict) {
+        int bound = LZ4_compressBound((int)payload.size());
+        std::vector<uint8_t> out(RelayStream::HEADER_SIZE + bound);
+        out[0] = mode;
+        out[1] = refEpoch;
+        uint32_t originalSize = (uint32_t)payload.size();
+        std::memcpy(out.data() + 2, &originalSize, 4);
+
+        LZ4_loadDict(stream, (const char*)dict.data(), (int)dict.size());
+        int size = LZ4_compress_fast_continue(stream, (const char*)payload.data(),
+            (char*)(out.data() + RelayStream::HEADER_SIZE), (int)payload.size(), bound, 1);
+        if (size <= 0 && !payload.empty()) return {};
+        out.resize(RelayStream::HEADER_SIZE + std::max(size, 0));
+        return out;
+    }
+
+    LZ4_stream_t* stream;
+    std::vector<uint8_t> chainDict;
+    std::vector<uint8_t> keyframes[2];
+    uint8_t epoch = 0;
+    int keyframesSent = 0;
+    int sinceKeyframe = 0;
+};
+
+class RelayStreamDecoder {
+public:
+    void Reset() {
+        chainDict.clear();
+        keyframes[0].clear(); keyframes[1].clear();
+        keyframeEpochs[0] = keyframeEpochs[1] = -1;
+    }
+
+    // Returns false when the packet can't be decoded (corrupt, or its keyframe hasn't arrived)
+    bool Decode(const std::vector<uint8_t>& data, std::vector<uint8_t>& out) {
+        if (data.size() < RelayStream::HEADER_SIZE) return false;
+        uint8_t mode = data[0];
+        uint8_t epoch = data[1];
+        uint32_t originalSize;
+        std::memcpy(&originalSize, data.data() + 2, 4);
+        if (originalSize > RelayStream::MAX_PAYLOAD_SIZE) return false;
+
+        const std::vector<uint8_t>* dict = nullptr;
+        static const std::vector<uint8_t> noDict;
+        if (mode == RelayStream::CHAINED) dict = &chainDict;
+        else if (mode == RelayStream::KEYFRAME) dict = &noDict;
+        else if (mode == RelayStream::DELTA) {
+            if (keyframeEpochs[epoch & 1] != epoch) return false;
+            dict = &keyframes[epoch & 1];
+        }
+        else return false;
+
+        out.resize(originalSize);
+        int result = LZ4_decompress_safe_usingDict((const char*)(data.data() + RelayStream::HEADER_SIZE), (char*)out.data(),
+            (int)(data.size() - RelayStream::HEADER_SIZE), (int)originalSize, (const char*)dict->data(), (int)dict->size());
+        if (result != (int)originalSize) return false;
+
+        if (mode == RelayStream::CHAINED) RelayStream::StoreDict(chainDict, out);
+        else if (mode == RelayStream::KEYFRAME) {
+            RelayStream::StoreDict(keyframes[epoch & 1], out);
+            keyframeEpochs[epoch & 1] = epoch;
+        }
+        return true;
+    }
+
+private:
+    std::vector<uint8_t> chainDict;
+    std::vector<uint8_t> keyframes[2];
+    int keyframeEpochs[2] = { -1, -1 };
+};
@@ -31,7 +31,7 @@ ENetClient::~ENetClient()
     }
 }
 
-bool ENetClient::connect(const std::string& host, uint32_t port)
+bool ENetClient::connectAsync(const std::string& host, uint32_t port)
 {
     if (!host_) {
         host_ = enet_host_create(nullptr, 1, NUM_CHANNELS, 0, 0);
@@ -41,7 +41,7 @@ bool ENetClient::connect(const std::string& host, uint32_t port)
         }
     }
 
-    if (isConnected()) {
+    if (isConnected() || isConnecting()) {
         return true;
     }
 
@@ -54,6 +54,18 @@ bool ENetClient::connect(const std::string& host, uint32_t port)
         LOG_ERROR("No available peers for initiating an ENet connection");
         return false;
     }
+    return true;
+}
+
+bool ENetClient::connect(const std::string& host, uint32_t port)
+{
+    if (isConnected()) {
+        return true;
+    }
+
+    if (!connectAsync(host, port)) {
+        return false;
+    }
 
     ENetEvent event;
     if (enet_host_service(host_, &event, TIMEOUT_MS) > 0 && event.type == ENET_EVENT_TYPE_CONNECT) {
@@ -106,11 +118,33 @@ bool ENetClient::disconnect()
     return !success;
 }
 
+void ENetClient::disconnectNow()
+{
+    if (!host_ || !server_) return;
+    enet_peer_disconnect_now(server_, 0);
+    enet_host_flush(host_);
+    server_ = nullptr;
+}
+
 bool ENetClient::isConnected() const
 {
     return host_ != nullptr && server_ != nullptr && server_->state == ENET_PEER_STATE_CONNECTED;
 }
 
+bool ENetClient::isConnecting() const
+{
+    return host_ != nullptr && server_ != nullptr && server_->state != ENET_PEER_STATE_CONNECTED
+        && server_->state != ENET_PEER_STATE_DISCONNECTED;
+}
+
+bool ENetClient::getLinkStats(uint32_t& roundTripTimeMs, float& packetLoss) const
+{
+    if (!isConnected()) return false;
+    roundTripTimeMs = server_->roundTripTime;
+    packetLoss = (float)server_->packetLoss / (float)ENET_PEER_PACKET_LOSS_SCALE;
+    return true;
+}
+
 void ENetClient::on(uint32_t id, RequestHandler handler)
 {
     handlers_[id] = handler;
@@ -206,6 +240,11 @@ std::vector<Message::Shared> ENetClient::poll()
                 }
                 enet_packet_destroy(event.packet);
             }
+            else if (event.type == ENET_EVENT_TYPE_CONNECT) {
+                // Only reached after connectAsync(); connect() consumes this event itself
+                auto msg = Message::alloc(SERVER_ID, MessageType::CONNECT);
+                msgs.push_back(msg);
+            }
             else if (event.type == ENET_EVENT_TYPE_DISCONNECT) {
                 auto msg = Message::alloc(SERVER_ID, MessageType::DISCONNECT);
                 msgs.push_back(msg);
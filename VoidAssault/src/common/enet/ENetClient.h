@@ -21,8 +21,14 @@ public:
     ~ENetClient();
 
     bool connect(const std::string&, uint32_t);
+    // Starts connecting and returns at once; poll() reports CONNECT, or DISCONNECT on failure
+    bool connectAsync(const std::string&, uint32_t);
     bool disconnect();
+    // Drops the connection without waiting for the server to acknowledge it
+    void disconnectNow();
     bool isConnected() const;
+    bool isConnecting() const;
+    bool getLinkStats(uint32_t& roundTripTimeMs, float& packetLoss) const;
 
     void send(DeliveryType, StreamBuffer::Shared) const;
     Message::Shared request(uint32_t, StreamBuffer::Shared);
@@ -38,6 +38,13 @@ uint16_t ENetServer::getPeerPort(uint32_t id) const {
     }
     return 0;
 }
+bool ENetServer::getPeerLinkStats(uint32_t id, uint32_t& roundTripTimeMs, float& packetLoss) const {
+    ENetPeer* peer = getClient(id);
+    if (!peer) return false;
+    roundTripTimeMs = peer->roundTripTime;
+    packetLoss = (float)peer->packetLoss / (float)ENET_PEER_PACKET_LOSS_SCALE;
+    return true;
+}
 ENetServer::Shared ENetServer::alloc()
 {
     return std::make_shared<ENetServer>();
@@ -145,6 +152,22 @@ void ENetServer::handleRequest(uint32_t id, uint32_t requestId, StreamBuffer::Sh
     }
 }
 
+void ENetServer::onRawPacket(RawPacketHandler handler)
+{
+    rawHandler_ = handler;
+}
+
+bool ENetServer::forward(uint32_t id, DeliveryType type, ENetPacket* packet) const
+{
+    if (!host_) return false;
+    auto client = getClient(id);
+    if (!client) return false;
+
+    uint32_t channel = (type == DeliveryType::RELIABLE) ? RELIABLE_CHANNEL : UNRELIABLE_CHANNEL;
+    packet->flags = (type == DeliveryType::RELIABLE) ? ENET_PACKET_FLAG_RELIABLE : ENET_PACKET_FLAG_UNSEQUENCED;
+    return enet_peer_send(client, channel, packet) == 0;
+}
+
 ENetPeer* ENetServer::getClient(uint32_t id) const
 {
     auto iter = clients_.find(id);
@@ -215,6 +238,11 @@ std::vector<Message::Shared> ENetServer::poll()
         int32_t res = enet_host_service(host_, &event, 0);
         if (res > 0) {
             if (event.type == ENET_EVENT_TYPE_RECEIVE) {
+                if (rawHandler_ && rawHandler_(event.peer->incomingPeerID, event.packet)) {
+                    // A forwarded packet is now referenced by the outgoing queue and freed by ENet
+                    if (event.packet->referenceCount == 0) enet_packet_destroy(event.packet);
+                    continue;
+                }
                 auto stream = StreamBuffer::alloc(event.packet->data, event.packet->dataLength);
                 auto msg = Message::alloc(event.peer->incomingPeerID);
                 msg->deserialize(stream);
@@ -11,6 +11,10 @@
 #include <memory>
 #include <vector>
 
+// Sees a received packet before it is turned into a Message. Returning true consumes it;
+// the packet may be handed to forward(), otherwise it is destroyed after the call.
+typedef std::function<bool(uint32_t, ENetPacket*)> RawPacketHandler;
+
 class ENetServer : public Server {
 
 public:
@@ -31,8 +35,11 @@ public:
     std::vector<Message::Shared> poll();
 
     void on(uint32_t, RequestHandler);
+    void onRawPacket(RawPacketHandler handler);
+    bool forward(uint32_t id, DeliveryType type, ENetPacket* packet) const;
     std::string getPeerIP(uint32_t id) const;
     uint16_t getPeerPort(uint32_t id) const;
+    bool getPeerLinkStats(uint32_t id, uint32_t& roundTripTimeMs, float& packetLoss) const;
     ENetHost* getHost() const { return host_; }
 private:
     ENetPeer* getClient(uint32_t) const;
@@ -53,6 +60,7 @@ private:
     std::map<uint32_t, ENetPeer*> clients_;
     std::vector<Message::Shared> queue_;
     std::map<uint32_t, RequestHandler> handlers_;
+    RawPacketHandler rawHandler_;
     mutable uint32_t currentMsgId_;
 };
 
@@ -23,6 +23,8 @@ class Message {
 
 public:
     typedef std::shared_ptr<Message> Shared;
+    // id (4) + requestId (4) + type (1), written ahead of the payload by serialize()
+    static const size_t HEADER_SIZE = 9;
     static Shared alloc(uint32_t id, uint8_t, StreamBuffer::Shared); // data
     static Shared alloc(uint32_t id, uint32_t requestId, uint8_t, StreamBuffer::Shared); // request / response
     static Shared alloc(uint32_t peerId, uint8_t); // connect / disconnect
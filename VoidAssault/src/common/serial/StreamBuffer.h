@@ -1,7 +1,7 @@
 ﻿#pragma once
 
 #include "../Common.h"
-#include "raylib.h"
+#include "../RaylibTypes.h"
 
 #include <memory>
 #include <vector>
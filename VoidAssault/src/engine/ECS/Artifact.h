@@ -13,5 +13,5 @@ public:
         cpShapeSetSensor(shape, true);
         cpShapeSetUserData(shape, (void*)this);
     }
-    void Update(float dt) override {}
+    void Update(float dt, double now) override {}
 };
\ No newline at end of file
@@ -17,7 +17,7 @@ public:
         level++;
         maxHealth *= 1.4f;         health = maxHealth;     }
 
-    virtual void Update(float dt) override {
+    virtual void Update(float dt, double now) override {
         if (lifetime > 0) {
             lifetime -= dt;
             if (lifetime <= 0) destroyFlag = true;
@@ -64,8 +64,8 @@ public:
         Construct::Upgrade();         damage *= 1.3f;               reloadTime *= 0.85f;          range += 20.0f;
     }
 
-    void Update(float dt) override {
-        Construct::Update(dt);
+    void Update(float dt, double now) override {
+        Construct::Update(dt, now);
         if (cooldown > 0) cooldown -= dt;
     }
 };
@@ -0,0 +1,112 @@
+﻿#pragma once
+#include "raylib_compatibility.h"
+#include "../../common/NetworkPackets.h"
+#include <vector>
+#include <unordered_map>
+#include <array>
+#include <cstdint>
+#include <cmath>
+
+// Which grid cell every wall, turret and mine occupies, plus how many of each type every
+// player owns. Constructs are always placed on grid points, so a cell holds at most one.
+// Kept in sync by GameScene on build and removal; also usable as a static obstacle map.
+class ConstructGrid {
+public:
+    static constexpr uint32_t EMPTY = 0;
+
+    void Resize(float worldWidth, float worldHeight, float cell) {
+        cellSize = cell;
+        cols = (int)std::floor(worldWidth / cellSize) + 1;
+        rows = (int)std::floor(worldHeight / cellSize) + 1;
+        Clear();
+    }
+
+    void Clear() {
+        cells.assign((size_t)cols * rows, EMPTY);
+        entries.clear();
+        owners.clear();
+    }
+
+    int Cols() const { return cols; }
+    int Rows() const { return rows; }
+
+    // Cell of the grid point nearest to pos, or -1 outside the map
+    int CellAt(Vector2 pos) const {
+        return CellIndex((int)std::lround(pos.x / cellSize), (int)std::lround(pos.y / cellSize));
+    }
+
+    int CellIndex(int x, int y) const {
+        if (x < 0 || y < 0 || x >= cols || y >= rows) return -1;
+        return y * cols + x;
+    }
+
+    Vector2 CellCenter(int cell) const {
+        return { (float)(cell % cols) * cellSize, (float)(cell / cols) * cellSize };
+    }
+
+    // Id of the construct in the cell, or EMPTY
+    uint32_t Occupant(int cell) const { return (cell < 0) ? EMPTY : cells[cell]; }
+    bool IsBlocked(int x, int y) const { return Occupant(CellIndex(x, y)) != EMPTY; }
+
+    bool Add(uint32_t id, EntityType type, uint32_t owner, Vector2 pos) {
+        int cell = CellAt(pos);
+        if (cell < 0 || cells[cell] != EMPTY) return false;
+        cells[cell] = id;
+        entries[id] = { cell, owner, type };
+        owners[owner][Slot(type)]++;
+        return true;
+    }
+
+    // No-op for ids that aren't constructs
+    void Remove(uint32_t id) {
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        const Entry& e = it->second;
+        if (cells[e.cell] == id) cells[e.cell] = EMPTY;
+        auto owner = owners.find(e.owner);
+        if (owner != owners.end()) {
+            owner->second[Slot(e.type)]--;
+            if (owner->second[0] == 0 && owner->second[1] == 0 && owner->second[2] == 0) owners.erase(owner);
+        }
+        entries.erase(it);
+    }
+
+    int Count(uint32_t owner, EntityType type) const {
+        auto it = owners.find(owner);
+        return (it == owners.end()) ? 0 : it->second[Slot(type)];
+    }
+
+    // Nearest construct within radius of pos (radius at most one cell), or EMPTY
+    uint32_t FindNear(Vector2 pos, float radius) const {
+        int cx = (int)std::floor(pos.x / cellSize), cy = (int)std::floor(pos.y / cellSize);
+        uint32_t best = EMPTY;
+        float bestDist = radius;
+        for (int y = cy; y <= cy + 1; y++) {
+            for (int x = cx; x <= cx + 1; x++) {
+                int cell = CellIndex(x, y);
+                if (cell < 0 || cells[cell] == EMPTY) continue;
+                float d = Vector2Distance(pos, CellCenter(cell));
+                if (d < bestDist) { bestDist = d; best = cells[cell]; }
+            }
+        }
+        return best;
+    }
+
+private:
+    struct Entry {
+        int cell;
+        uint32_t owner;
+        EntityType type;
+    };
+
+    static int Slot(EntityType type) {
+        return (type == EntityType::WALL) ? 0 : ((type == EntityType::TURRET) ? 1 : 2);
+    }
+
+    float cellSize = 50.0f;
+    int cols = 0;
+    int rows = 0;
+    std::vector<uint32_t> cells;
+    std::unordered_map<uint32_t, Entry> entries;
+    std::unordered_map<uint32_t, std::array<int, 3>> owners;
+};
@@ -1,7 +1,6 @@
 ﻿#pragma once
 #include "GameObject.h"
 #include "../PhysicsUtils.h"
-#include "raymath.h"
 #include "../../common/NetworkPackets.h"
 
 class Enemy : public GameObject {
@@ -69,30 +68,47 @@ public:
         cpShapeSetUserData(shape, (void*)this);
     }
 
-    void Update(float dt) override {
-        if (health < maxHealth) health += maxHealth * 0.005f * dt;
+    // 60% basic, 25% fast, 13% tank, 2% boss
+    static uint8_t RandomType() {
+        int chance = rand() % 100;
+        if (chance < 60) return EnemyType::BASIC;
+        if (chance < 85) return EnemyType::FAST;
+        if (chance < 98) return EnemyType::TANK;
+        return EnemyType::BOSS;
+    }
+
+    // Result of steering, computed off the main thread and applied to the body afterwards
+    struct SteeringIntent {
+        cpVect velocity;
+        float angle;
+    };
 
-        cpVect currentVel = cpBodyGetVelocity(body);
-        cpBodySetVelocity(body, cpvmult(currentVel, 0.90f));
+    void Update(float dt, double now) override {
+        if (health < maxHealth) health += maxHealth * 0.005f * dt;
+    }
 
+    // Pure function of the enemy's body state and target, safe to run in parallel
+    SteeringIntent Steer(Vector2 pos, cpVect currentVel, Vector2 targetPos) const {
+        cpVect vel = cpvmult(currentVel, 0.90f);
         float currentSpeed = cpvlength(currentVel);
-        if (currentSpeed > speed * 3.0f) {
-            cpBodySetVelocity(body, cpvmult(cpvnormalize(currentVel), speed * 3.0f));
+        if (currentSpeed > speed * 3.0f) vel = cpvmult(cpvnormalize(currentVel), speed * 3.0f);
+
+        Vector2 dir = Vector2Subtract(targetPos, pos);
+        SteeringIntent intent;
+        intent.angle = atan2(dir.y, dir.x);
+        if (Vector2Length(dir) >= 5.0f) {
+            Vector2 moveDir = Vector2Normalize(dir);
+            cpVect desiredVel = cpv(moveDir.x * speed, moveDir.y * speed);
+            vel = cpvlerp(vel, desiredVel, 0.1f);
         }
+        intent.velocity = vel;
+        return intent;
     }
 
-    void MoveTowards(Vector2 targetPos) {
+    void ApplySteering(const SteeringIntent& intent) {
         if (!body) return;
-        Vector2 pos = ToRay(cpBodyGetPosition(body));
-        Vector2 dir = Vector2Subtract(targetPos, pos);
-        float angle = atan2(dir.y, dir.x);
-        cpBodySetAngle(body, angle);
-        rotation = angle * RAD2DEG;
-
-        if (Vector2Length(dir) < 5.0f) return;
-        Vector2 moveDir = Vector2Normalize(dir);
-        cpVect desiredVel = cpv(moveDir.x * speed, moveDir.y * speed);
-        cpVect currentVel = cpBodyGetVelocity(body);
-        cpBodySetVelocity(body, cpvlerp(currentVel, desiredVel, 0.1f));
+        cpBodySetAngle(body, intent.angle);
+        rotation = intent.angle * RAD2DEG;
+        cpBodySetVelocity(body, intent.velocity);
     }
 };
\ No newline at end of file
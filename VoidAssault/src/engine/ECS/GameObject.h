@@ -1,6 +1,6 @@
 ﻿#pragma once
 #include "fix_win32_compatibility.h"
-#include "raylib.h"
+#include "raylib_compatibility.h"
 #include "chipmunk/chipmunk.h"
 #include "../../common/NetworkPackets.h"
 
@@ -20,6 +20,8 @@ public:
     cpSpace* spaceRef = nullptr;
 
     bool destroyFlag = false;
+    // Already in GameScene's despawn queue
+    bool despawnQueued = false;
     Color color = RED;
     float rotation = 0.0f;
     float health = 100.0f;
@@ -27,6 +29,14 @@ public:
 
     double lastDamageTime = 0.0;
 
+    // Set every tick by GameScene::UpdateActivity. DORMANT objects are far from every player
+    // and only update every few ticks; ASLEEP ones don't update at all.
+    enum Activity : uint8_t { ACTIVE, DORMANT, ASLEEP };
+    Activity activity = ACTIVE;
+    bool tickDue = true;
+    // Time skipped while dormant, passed on to the next Update that runs
+    float idleDt = 0.0f;
+
     GameObject(uint32_t _id, EntityType _type) : id(_id), type(_type) {}
 
     virtual ~GameObject() {
@@ -36,7 +46,8 @@ public:
         }
     }
 
-    virtual void Update(float dt) = 0;
+    // now is simulation time (GameScene::clock), not wall time
+    virtual void Update(float dt, double now) = 0;
 
     void TakeDamage(float amount, double currentTime) {
         health -= amount;
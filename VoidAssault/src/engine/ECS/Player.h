@@ -1,7 +1,6 @@
 ﻿#pragma once
 #include "GameObject.h"
 #include "../PhysicsUtils.h"
-#include "raymath.h"
 #include <vector>
 #include <string>
 
@@ -23,6 +22,11 @@ public:
     uint32_t scrap = 0; uint32_t kills = 0;
     bool isAdmin = false;
 
+    // StatsField bits changed since the owner's last stats packet
+    uint16_t statsDirty = StatsField::ALL;
+    // Bumped every time the derived cur* stats are recomputed
+    uint32_t statsVersion = 0;
+
     uint8_t inventory[6];
     ArtifactStats artifacts;
 
@@ -57,11 +61,35 @@ public:
         health = maxHealth;
     }
 
+    // Stats take effect at the next CommitStats; health stays at or below zero until then,
+    // so the rest of the tick treats the player as dead
     void Reset() {
         level = 1; currentXp = 0; maxXp = 100.0f; scrap = 0; kills = 0;
-        health = maxHealth;
+        pendingXp = 0.0f;
         for (int i = 0; i < 6; ++i) inventory[i] = ArtifactType::EMPTY;
-        RecalculateStats();
+        statsStale = true;
+        refillHealth = true;
+        statsDirty = StatsField::ALL;
+    }
+
+    // Applies XP granted since the last call and recomputes derived stats if anything they
+    // depend on changed. Called once per tick by GameScene, after all damage and pickups.
+    void CommitStats() {
+        if (pendingXp > 0.0f) {
+            currentXp += pendingXp;
+            pendingXp = 0.0f;
+            statsDirty |= StatsField::CURRENT_XP;
+            uint32_t startLevel = level;
+            while (currentXp >= maxXp) { currentXp -= maxXp; level++; maxXp *= 1.2f; }
+            if (level != startLevel) {
+                statsStale = true;
+                refillHealth = true;
+                statsDirty |= StatsField::LEVEL | StatsField::MAX_XP;
+            }
+        }
+        if (statsStale) RecalculateStats();
+        if (refillHealth) health = maxHealth;
+        refillHealth = false;
     }
 
     void RecalculateStats() {
@@ -89,28 +117,43 @@ public:
                 curBulletPen = 1.5f + (lvl * 0.05f);
 
         if (health > maxHealth) health = maxHealth;
+        statsDirty |= StatsField::MAX_HEALTH | StatsField::DAMAGE | StatsField::SPEED;
+        statsStale = false;
+        statsVersion++;
     }
 
     bool AddItemToInventory(uint8_t type) {
         for (int i = 0; i < 6; i++) {
             if (inventory[i] == ArtifactType::EMPTY) {
-                inventory[i] = type; RecalculateStats(); return true;
+                inventory[i] = type; statsDirty |= StatsField::INVENTORY; statsStale = true; return true;
             }
         }
         return false;
     }
 
+    // Batched until CommitStats, so many kills in one tick level up in a single pass
     void AddXp(float amount) {
-        currentXp += amount;
-        while (currentXp >= maxXp) {
-            currentXp -= maxXp; level++; maxXp *= 1.2f; RecalculateStats(); health = maxHealth;
-        }
+        if (amount > 0.0f) pendingXp += amount;
     }
 
-    void Update(float dt) override {
-        double currentTime = GetTime();
+    void AddScrap(uint32_t amount) { scrap += amount; statsDirty |= StatsField::SCRAP; }
+
+    bool SpendScrap(uint32_t amount) {
+        if (scrap < amount) return false;
+        scrap -= amount; statsDirty |= StatsField::SCRAP;
+        return true;
+    }
+
+    void AddKill() { kills++; statsDirty |= StatsField::KILLS; }
+
+    void SetAdmin(bool admin) {
+        if (isAdmin != admin) statsDirty |= StatsField::ADMIN;
+        isAdmin = admin;
+    }
+
+    void Update(float dt, double now) override {
         float regen = curRegen;
-        if (currentTime - lastDamageTime > 10.0) regen *= 4.0f;
+        if (now - lastDamageTime > 10.0) regen *= 4.0f;
         health += regen * dt;
         if (health > maxHealth) health = maxHealth;
 
@@ -141,4 +184,9 @@ public:
         cpBodySetVelocity(body, cpv(finalVel.x, finalVel.y));
         cpBodySetAngularVelocity(body, 0.0f);
     }
+
+private:
+    float pendingXp = 0.0f;
+    bool statsStale = false;
+    bool refillHealth = false;
 };
\ No newline at end of file
@@ -0,0 +1,149 @@
+﻿#pragma once
+#include "raylib_compatibility.h"
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include <cmath>
+
+// Player and turret bullets, kept as plain arrays outside cpSpace. They move in straight
+// lines and are hit-tested as swept segments, so a fast bullet can't skip over a target
+// between two ticks and the physics solver never sees them.
+class ProjectileSystem {
+public:
+    std::vector<uint32_t> ids;
+    std::vector<Vector2> positions;
+    // Position at the start of the last Advance, the other end of the swept segment
+    std::vector<Vector2> previous;
+    std::vector<Vector2> velocities;
+    std::vector<float> lifetimes;
+    std::vector<uint32_t> owners;
+    std::vector<uint8_t> dead;
+
+    size_t Size() const { return ids.size(); }
+
+    void Spawn(uint32_t id, Vector2 pos, Vector2 velocity, float lifetime, uint32_t owner) {
+        if (!std::isfinite(velocity.x) || !std::isfinite(velocity.y)) velocity = { 600.0f, 0.0f };
+        ids.push_back(id);
+        positions.push_back(pos);
+        previous.push_back(pos);
+        velocities.push_back(velocity);
+        lifetimes.push_back(lifetime);
+        owners.push_back(owner);
+        dead.push_back(0);
+    }
+
+    void Advance(float dt) {
+        for (size_t i = 0; i < ids.size(); i++) {
+            previous[i] = positions[i];
+            positions[i].x += velocities[i].x * dt;
+            positions[i].y += velocities[i].y * dt;
+            lifetimes[i] -= dt;
+            if (lifetimes[i] <= 0) dead[i] = 1;
+        }
+    }
+
+    void Kill(size_t i) { dead[i] = 1; }
+
+    // Swap-and-pop, so the order of the remaining projectiles is not preserved.
+    // The ids of removed projectiles are appended to removedIds.
+    void RemoveDead(std::vector<uint32_t>& removedIds) {
+        for (size_t i = 0; i < ids.size();) {
+            if (!dead[i]) { i++; continue; }
+            removedIds.push_back(ids[i]);
+            size_t last = ids.size() - 1;
+            ids[i] = ids[last]; positions[i] = positions[last]; previous[i] = previous[last];
+            velocities[i] = velocities[last]; lifetimes[i] = lifetimes[last];
+            owners[i] = owners[last]; dead[i] = dead[last];
+            ids.pop_back(); positions.pop_back(); previous.pop_back();
+            velocities.pop_back(); lifetimes.pop_back(); owners.pop_back(); dead.pop_back();
+        }
+    }
+
+    void Clear() {
+        ids.clear(); positions.clear(); previous.clear();
+        velocities.clear(); lifetimes.clear(); owners.clear(); dead.clear();
+    }
+};
+
+// Uniform grid of target circles, rebuilt every tick, for swept projectile queries
+class SweepGrid {
+public:
+    explicit SweepGrid(float cellSize = 100.0f) : cellSize(cellSize) {}
+
+    void Clear() {
+        for (auto& [key, cell] : cells) cell.clear();
+        circles.clear();
+    }
+
+    void Insert(Vector2 pos, float radius, uint32_t index) {
+        circles.push_back({ pos, radius, index });
+        uint32_t slot = (uint32_t)circles.size() - 1;
+        int x0 = Cell(pos.x - radius), x1 = Cell(pos.x + radius);
+        int y0 = Cell(pos.y - radius), y1 = Cell(pos.y + radius);
+        for (int y = y0; y <= y1; y++)
+            for (int x = x0; x <= x1; x++) cells[Key(x, y)].push_back(slot);
+    }
+
+    // Index of the eligible circle that segment a->b enters first, or -1.
+    // hitPoint is where the segment enters it.
+    template <typename Filter>
+    int FirstHit(Vector2 a, Vector2 b, Filter eligible, Vector2& hitPoint) {
+        if (circles.empty()) return -1;
+        if (stamps.size() < circles.size()) stamps.resize(circles.size(), 0);
+        query++;
+
+        int x0 = Cell(std::fmin(a.x, b.x)), x1 = Cell(std::fmax(a.x, b.x));
+        int y0 = Cell(std::fmin(a.y, b.y)), y1 = Cell(std::fmax(a.y, b.y));
+        Vector2 d = Vector2Subtract(b, a);
+
+        int best = -1;
+        float bestT = 2.0f;
+        for (int y = y0; y <= y1; y++) {
+            for (int x = x0; x <= x1; x++) {
+                auto it = cells.find(Key(x, y));
+                if (it == cells.end()) continue;
+                for (uint32_t slot : it->second) {
+                    if (stamps[slot] == query) continue;
+                    stamps[slot] = query;
+                    const Circle& c = circles[slot];
+                    float t;
+                    if (!SegmentEntersCircle(a, d, c.pos, c.radius, t) || t >= bestT || !eligible(c.index)) continue;
+                    bestT = t;
+                    best = (int)c.index;
+                }
+            }
+        }
+        if (best >= 0) hitPoint = Vector2Add(a, Vector2Scale(d, bestT));
+        return best;
+    }
+
+private:
+    struct Circle {
+        Vector2 pos;
+        float radius;
+        uint32_t index;
+    };
+
+    int Cell(float v) const { return (int)std::floor(v / cellSize); }
+    static int64_t Key(int x, int y) { return ((int64_t)x << 32) ^ (uint32_t)y; }
+
+    // Smallest t in [0, 1] with |a + t*d - c| <= r
+    static bool SegmentEntersCircle(Vector2 a, Vector2 d, Vector2 c, float r, float& t) {
+        Vector2 f = Vector2Subtract(a, c);
+        float cc = f.x * f.x + f.y * f.y - r * r;
+        if (cc <= 0.0f) { t = 0.0f; return true; }
+        float aa = d.x * d.x + d.y * d.y;
+        if (aa <= 1e-8f) return false;
+        float bb = 2.0f * (f.x * d.x + f.y * d.y);
+        float disc = bb * bb - 4.0f * aa * cc;
+        if (disc < 0.0f) return false;
+        t = (-bb - std::sqrt(disc)) / (2.0f * aa);
+        return t >= 0.0f && t <= 1.0f;
+    }
+
+    float cellSize;
+    std::unordered_map<int64_t, std::vector<uint32_t>> cells;
+    std::vector<Circle> circles;
+    std::vector<uint32_t> stamps;
+    uint32_t query = 0;
+};
@@ -0,0 +1,69 @@
+﻿#pragma once
+#include <unordered_map>
+#include <vector>
+#include <cstdint>
+
+// Players connected to the server and how packets reach them: a direct ENet peer,
+// or a relay session through the master server. Lookups by player id are O(1), and
+// each transport keeps its ids in join order so broadcasts iterate deterministically.
+class PeerTable {
+public:
+    enum class Transport : uint8_t {
+        DIRECT = 0,
+        RELAY = 1
+    };
+
+    // Returns false if the id is already known
+    bool Add(uint32_t id, Transport transport) {
+        if (entries.count(id)) return false;
+        auto& ids = ordered[(size_t)transport];
+        entries[id] = { transport, ids.size() };
+        ids.push_back(id);
+        return true;
+    }
+
+    void Remove(uint32_t id) {
+        auto it = entries.find(id);
+        if (it == entries.end()) return;
+        auto& ids = ordered[(size_t)it->second.transport];
+        size_t index = it->second.index;
+        entries.erase(it);
+        // Keep join order; leaving players are rare compared to per-packet lookups
+        ids.erase(ids.begin() + index);
+        for (size_t i = index; i < ids.size(); i++) entries[ids[i]].index = i;
+    }
+
+    bool Contains(uint32_t id) const { return entries.count(id) > 0; }
+
+    bool IsRelay(uint32_t id) const {
+        auto it = entries.find(id);
+        return it != entries.end() && it->second.transport == Transport::RELAY;
+    }
+
+    const std::vector<uint32_t>& Ids(Transport transport) const { return ordered[(size_t)transport]; }
+    const std::vector<uint32_t>& RelayIds() const { return Ids(Transport::RELAY); }
+    size_t Size() const { return entries.size(); }
+
+    // Drops every peer of one transport, e.g. all relay sessions when the master link is lost
+    std::vector<uint32_t> RemoveAll(Transport transport) {
+        std::vector<uint32_t> removed;
+        removed.swap(ordered[(size_t)transport]);
+        for (uint32_t id : removed) entries.erase(id);
+        return removed;
+    }
+
+    void Clear() {
+        entries.clear();
+        ordered[0].clear();
+        ordered[1].clear();
+    }
+
+private:
+    struct Entry {
+        Transport transport;
+        size_t index;
+    };
+
+    std::unordered_map<uint32_t, Entry> entries;
+    std::vector<uint32_t> ordered[2];
+};
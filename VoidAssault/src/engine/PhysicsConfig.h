@@ -0,0 +1,61 @@
+﻿#pragma once
+#include "chipmunk/chipmunk.h"
+#include <algorithm>
+
+// cpHastySpace needs pthreads, which the Windows builds don't link
+#if !defined(_WIN32)
+#define VOID_HASTY_SPACE 1
+#include "chipmunk/cpHastySpace.h"
+#endif
+
+struct PhysicsSettings {
+    int iterations = 10;
+    // Solver threads; more than 1 uses cpHastySpace where available
+    int solverThreads = 1;
+    // Spatial hash instead of the default bounding box tree for the dynamic shapes
+    bool spatialHash = true;
+    // Roughly the diameter of the common shapes: players 40, basic enemies 40, walls 50
+    float hashCellSize = 50.0f;
+    int hashCells = 4096;
+};
+
+// Creates, steps and frees a cpSpace according to PhysicsSettings, so callers
+// don't need to know whether it is a threaded cpHastySpace
+class PhysicsSpace {
+public:
+    static cpSpace* Create(const PhysicsSettings& settings, bool& threaded) {
+        cpSpace* space = nullptr;
+        threaded = false;
+#ifdef VOID_HASTY_SPACE
+        if (settings.solverThreads > 1) {
+            space = cpHastySpaceNew();
+            cpHastySpaceSetThreads(space, (unsigned long)settings.solverThreads);
+            threaded = true;
+        }
+#endif
+        if (!space) space = cpSpaceNew();
+        Apply(space, settings);
+        return space;
+    }
+
+    // Settings that can change on an existing space; the solver type can't, and a space
+    // can be switched to the spatial hash but not back to the bounding box tree
+    static void Apply(cpSpace* space, const PhysicsSettings& settings) {
+        cpSpaceSetIterations(space, std::max(1, settings.iterations));
+        if (settings.spatialHash) cpSpaceUseSpatialHash(space, settings.hashCellSize, std::max(64, settings.hashCells));
+    }
+
+    static void Step(cpSpace* space, bool threaded, cpFloat dt) {
+#ifdef VOID_HASTY_SPACE
+        if (threaded) { cpHastySpaceStep(space, dt); return; }
+#endif
+        cpSpaceStep(space, dt);
+    }
+
+    static void Free(cpSpace* space, bool threaded) {
+#ifdef VOID_HASTY_SPACE
+        if (threaded) { cpHastySpaceFree(space); return; }
+#endif
+        cpSpaceFree(space);
+    }
+};
@@ -5,33 +5,126 @@
 #include <algorithm>
 #include <cmath>
 #include "../ECS/Player.h"
-#include "../ECS/Bullet.h"
+#include "../ECS/ProjectileSystem.h"
 #include "../ECS/Enemy.h"
 #include "../ECS/Construct.h"
+#include "../ECS/ConstructGrid.h"
 #include "../ECS/Artifact.h"
 #include "../PhysicsUtils.h"
+#include "../PhysicsConfig.h"
+#include "../Utils/TickProfiler.h"
+#include "../Utils/SimClock.h"
+#include "../Utils/JobSystem.h"
+#include "../Utils/IdAllocator.h"
 #include "../../common/NetworkPackets.h"
 
 class GameScene {
 public:
     cpSpace* space;
-    std::map<uint32_t, std::shared_ptr<GameObject>> objects;
+    typedef std::map<uint32_t, std::shared_ptr<GameObject>> ObjectMap;
+    ObjectMap objects;
     std::vector<EventPacket> pendingEvents;
     float pvpFactor = 1.0f;
-    uint32_t nextId = 1000;
+    IdAllocator entityIds;
+    // Enemies in objects, kept up to date by FlushCommands
+    int numEnemies = 0;
     float width = 4000;
     float height = 4000;
     const float GRID_SIZE = 50.0f;
+    const float TURRET_BULLET_SPEED = 600.0f;
+    const float TURRET_BULLET_LIFETIME = 2.0f;
+
+    // Read-only copy of what AI jobs need, rebuilt every tick before they run. Entities are
+    // in id order and every job writes only its own intent slot, so the result doesn't
+    // depend on how the work was split across threads.
+    struct AiView {
+        std::vector<Enemy*> enemies;
+        std::vector<Vector2> enemyPos;
+        std::vector<cpVect> enemyVel;
+        // Dormant enemies keep their velocity and are only steered on their due ticks
+        std::vector<uint8_t> enemySteer;
+        // Players and turrets, which enemies chase
+        std::vector<Vector2> targetPos;
+        std::vector<Turret*> turrets;
+        std::vector<Vector2> turretPos;
+        std::vector<Mine*> mines;
+        std::vector<Vector2> minePos;
+
+        std::vector<Enemy::SteeringIntent> steering;
+        // Index into enemies, or -1
+        std::vector<int> turretTarget;
+        std::vector<int> mineTarget;
+    };
+    AiView ai;
+    JobSystem jobs;
+
+    ProjectileSystem projectiles;
+    SweepGrid enemyGrid;
+    SweepGrid playerGrid;
+    SweepGrid structureGrid;
+    ConstructGrid constructs;
+    TickProfiler profiler;
+
+    PhysicsSettings physics;
+    bool threadedSolver = false;
+
+    SimClock clock;
+
+    float dormancyRadius = 1500.0f;
+    int dormantTickInterval = 4;
+    std::vector<Vector2> activityPlayers;
+
+    // Spawns and despawns are buffered and applied together by FlushCommands at the end of
+    // every tick, so nothing mutates objects while the tick iterates it
+    std::vector<std::shared_ptr<GameObject>> spawnQueue;
+    std::vector<std::shared_ptr<GameObject>> despawnQueue;
+    // Map nodes of despawned objects, reused by the next spawns
+    std::vector<ObjectMap::node_type> spareNodes;
+    const size_t MAX_SPARE_NODES = 256;
+    std::vector<uint32_t> removedProjectileIds;
 
     GameScene() {
-        space = cpSpaceNew();
-        cpSpaceSetGravity(space, cpv(0, 0));
-        CreateMapBoundaries();
+        CreateSpace();
+        constructs.Resize(width, height, GRID_SIZE);
     }
 
     ~GameScene() {
+        jobs.Shutdown();
+        // Queued objects still own bodies in the space, release them before it is freed
+        spawnQueue.clear();
+        despawnQueue.clear();
+        spareNodes.clear();
         objects.clear();
-        cpSpaceFree(space);
+        PhysicsSpace::Free(space, threadedSolver);
+    }
+
+    void CreateSpace() {
+        space = PhysicsSpace::Create(physics, threadedSolver);
+        cpSpaceSetGravity(space, cpv(0, 0));
+        CreateMapBoundaries();
+    }
+
+    // Switching between the single and multithreaded solver, or between the spatial hash and
+    // the bounding box tree, needs a new space, so it only takes effect while the scene is
+    // empty (at server start)
+    void ConfigurePhysics(const PhysicsSettings& settings) {
+        bool wantThreaded = settings.solverThreads > 1;
+        bool needsNewSpace = wantThreaded != threadedSolver || settings.spatialHash != physics.spatialHash;
+        physics = settings;
+        if (needsNewSpace && objects.empty() && spawnQueue.empty() && despawnQueue.empty()) {
+            PhysicsSpace::Free(space, threadedSolver);
+            CreateSpace();
+        }
+        else PhysicsSpace::Apply(space, physics);
+    }
+
+    void ConfigureJobs(int threads, bool deterministic) {
+        jobs.Start(threads, deterministic);
+    }
+
+    void ConfigureDormancy(float radius, int tickInterval) {
+        dormancyRadius = radius;
+        dormantTickInterval = std::max(1, tickInterval);
     }
 
     void CreateMapBoundaries() {
@@ -61,12 +154,12 @@ public:
         auto p = std::dynamic_pointer_cast<Player>(objects[playerId]);
         if (!p) return;
 
-        if (cmd.cmdType == AdminCmdType::LOGIN) p->isAdmin = true;
+        if (cmd.cmdType == AdminCmdType::LOGIN) p->SetAdmin(true);
         if (!p->isAdmin) return;
 
         switch (cmd.cmdType) {
         case AdminCmdType::GIVE_SCRAP:
-            p->scrap += cmd.value;
+            p->AddScrap(cmd.value);
             break;
         case AdminCmdType::GIVE_XP:
             p->AddXp((float)cmd.value);
@@ -86,7 +179,7 @@ public:
                 if (obj->type == EntityType::WALL ||
                     obj->type == EntityType::TURRET ||
                     obj->type == EntityType::MINE) {
-                    obj->destroyFlag = true;
+                    Despawn(obj);
                                         if (obj->body) {
                         Vector2 pos = ToRay(cpBodyGetPosition(obj->body));
                         pendingEvents.push_back({ 1, pos, GRAY });
@@ -96,12 +189,14 @@ public:
         } break;
 
                                                   case AdminCmdType::RESET_SERVER: {
+            projectiles.Clear();
+            constructs.Clear();
+            spawnQueue.clear();
                         auto it = objects.begin();
             while (it != objects.end()) {
                 if (it->second->type != EntityType::PLAYER) {
-                                        if (it->second->body) {
-                                            }
-                    it = objects.erase(it);
+                    Despawn(it->second);
+                    ++it;
                 }
                 else {
                                         auto pl = std::dynamic_pointer_cast<Player>(it->second);
@@ -128,37 +223,24 @@ public:
                 if (pos.x < GRID_SIZE || pos.x > width - GRID_SIZE || pos.y < GRID_SIZE || pos.y > height - GRID_SIZE) return;
                 if (Vector2Distance(ToRay(cpBodyGetPosition(p->body)), pos) > 400.0f) return;
 
-                for (auto& [id, obj] : objects) {
-            if (obj->type == EntityType::WALL || obj->type == EntityType::TURRET || obj->type == EntityType::MINE) {
-                if (Vector2Distance(ToRay(cpBodyGetPosition(obj->body)), pos) < (GRID_SIZE / 2.0f)) return;
-            }
-        }
-
-                if (buildType == ActionType::BUILD_TURRET) {
-            int myTurrets = 0;
-            for (auto& [id, obj] : objects) {
-                if (obj->type == EntityType::TURRET) {
-                    auto t = std::dynamic_pointer_cast<Turret>(obj);
-                    if (t && t->ownerId == playerId) myTurrets++;
-                }
-            }
-            if (myTurrets >= 5) return;
-        }
+        if (constructs.Occupant(constructs.CellAt(pos)) != ConstructGrid::EMPTY) return;
+        if (buildType == ActionType::BUILD_TURRET && constructs.Count(playerId, EntityType::TURRET) >= 5) return;
 
         int cost = 0;
         if (buildType == ActionType::BUILD_WALL) cost = 10;
         else if (buildType == ActionType::BUILD_TURRET) cost = 50;
         else if (buildType == ActionType::BUILD_MINE) cost = 25;
 
-        if (p->scrap >= cost) {
-            p->scrap -= cost;
+        if (p->SpendScrap(cost)) {
             std::shared_ptr<GameObject> obj = nullptr;
-            if (buildType == ActionType::BUILD_WALL) obj = std::make_shared<Wall>(nextId++, pos, p->id, space);
-            else if (buildType == ActionType::BUILD_TURRET) obj = std::make_shared<Turret>(nextId++, pos, p->id, space);
-            else if (buildType == ActionType::BUILD_MINE) obj = std::make_shared<Mine>(nextId++, pos, p->id, space);
+            if (buildType == ActionType::BUILD_WALL) obj = std::make_shared<Wall>(NewId(), pos, p->id, space);
+            else if (buildType == ActionType::BUILD_TURRET) obj = std::make_shared<Turret>(NewId(), pos, p->id, space);
+            else if (buildType == ActionType::BUILD_MINE) obj = std::make_shared<Mine>(NewId(), pos, p->id, space);
 
             if (obj) {
-                objects[obj->id] = obj;
+                // The cell is claimed now so a second build this frame is rejected
+                Spawn(obj);
+                constructs.Add(obj->id, obj->type, p->id, pos);
                 pendingEvents.push_back({ 1, pos, WHITE });
             }
         }
@@ -167,21 +249,16 @@ public:
     void TryUpgrade(uint32_t playerId, Vector2 rawPos) {
         if (!objects.count(playerId)) return;
         auto p = std::dynamic_pointer_cast<Player>(objects[playerId]);
+        if (!p) return;
 
-        for (auto& [id, obj] : objects) {
-            if (obj->type == EntityType::WALL || obj->type == EntityType::TURRET || obj->type == EntityType::MINE) {
-                Vector2 objPos = ToRay(cpBodyGetPosition(obj->body));
-                                if (Vector2Distance(rawPos, objPos) < 30.0f) {
-                    auto c = std::dynamic_pointer_cast<Construct>(obj);
-                    int cost = 20 * c->level;
-                    if (p->scrap >= cost) {
-                        p->scrap -= cost;
-                        c->Upgrade();
-                        pendingEvents.push_back({ 2, objPos, GREEN });
-                    }
-                    return;
-                }
-            }
+        auto it = objects.find(constructs.FindNear(rawPos, 30.0f));
+        if (it == objects.end()) return;
+        auto c = std::dynamic_pointer_cast<Construct>(it->second);
+        if (!c) return;
+        int cost = 20 * c->level;
+        if (p->SpendScrap(cost)) {
+            c->Upgrade();
+            pendingEvents.push_back({ 2, ToRay(cpBodyGetPosition(c->body)), GREEN });
         }
     }
 
@@ -190,7 +267,7 @@ public:
         if (objects.count(id)) objects.erase(id);
         auto p = std::make_shared<Player>(id, startPos, space);
         p->Reset();
-        if (objects.size() == 0) p->isAdmin = true;         objects[id] = p;
+        if (objects.size() == 0) p->SetAdmin(true);         objects[id] = p;
         return p;
     }
 
@@ -204,33 +281,91 @@ public:
         else if (side == 2) { spawnX = (float)(rand() % (int)width); spawnY = -offset; }
         else { spawnX = (float)(rand() % (int)width); spawnY = height + offset; }
 
-        uint8_t type = EnemyType::BASIC;
-        if (forcedType != 255) {
-            type = forcedType;
-        }
-        else {
-            int chance = rand() % 100;
-            if (chance < 60) type = EnemyType::BASIC;
-            else if (chance < 85) type = EnemyType::FAST;
-            else if (chance < 98) type = EnemyType::TANK;
-            else type = EnemyType::BOSS;
-        }
+        uint8_t type = (forcedType != 255) ? forcedType : Enemy::RandomType();
 
-        auto enemy = std::make_shared<Enemy>(nextId++, Vector2{ spawnX, spawnY }, type, space);
-        objects[enemy->id] = enemy;
+        auto enemy = std::make_shared<Enemy>(NewId(), Vector2{ spawnX, spawnY }, type, space);
+        Spawn(enemy);
         return enemy;
     }
 
-    void Update(float dt) {
-        cpSpaceSetIterations(space, 10);
-        cpSpaceStep(space, dt);
-        EnforceMapBoundaries();
+    uint32_t NewId() { return entityIds.Allocate(clock.Now()); }
 
-        std::vector<std::shared_ptr<Bullet>> newBullets;
+    // Added to objects at the next FlushCommands
+    void Spawn(const std::shared_ptr<GameObject>& obj) {
+        spawnQueue.push_back(obj);
+    }
+
+    // Marks the object destroyed; it stays in objects until the next FlushCommands
+    void Despawn(const std::shared_ptr<GameObject>& obj) {
+        obj->destroyFlag = true;
+        if (obj->despawnQueued) return;
+        obj->despawnQueued = true;
+        despawnQueue.push_back(obj);
+    }
+
+    void Despawn(uint32_t id) {
+        auto it = objects.find(id);
+        if (it != objects.end()) Despawn(it->second);
+    }
+
+    // Applies queued despawns, then spawns. All shapes and bodies leaving the space are
+    // removed in one pass before any is freed, and their map nodes and ids are recycled.
+    void FlushCommands() {
+        double now = clock.Now();
+        if (!despawnQueue.empty()) {
+            for (auto& obj : despawnQueue) if (obj->shape) cpSpaceRemoveShape(space, obj->shape);
+            for (auto& obj : despawnQueue) if (obj->body) cpSpaceRemoveBody(space, obj->body);
+            for (auto& obj : despawnQueue) {
+                if (obj->shape) { cpShapeFree(obj->shape); obj->shape = nullptr; }
+                if (obj->body) { cpBodyFree(obj->body); obj->body = nullptr; }
+
+                // A player recreated under the same id replaced this object already
+                auto it = objects.find(obj->id);
+                if (it == objects.end() || it->second != obj) continue;
+                constructs.Remove(obj->id);
+                if (obj->type != EntityType::PLAYER) entityIds.Release(obj->id, now);
+                if (obj->type == EntityType::ENEMY) numEnemies--;
+                auto node = objects.extract(it);
+                node.mapped().reset();
+                if (spareNodes.size() < MAX_SPARE_NODES) spareNodes.push_back(std::move(node));
+            }
+            despawnQueue.clear();
+        }
 
-        for (auto it = objects.begin(); it != objects.end();) {
-            auto& obj = it->second;
-            obj->Update(dt);
+        for (auto& obj : spawnQueue) {
+            if (obj->destroyFlag) continue;
+            if (obj->type == EntityType::ENEMY) numEnemies++;
+            if (spareNodes.empty()) { objects[obj->id] = obj; continue; }
+            auto node = std::move(spareNodes.back());
+            spareNodes.pop_back();
+            node.key() = obj->id;
+            node.mapped() = obj;
+            auto result = objects.insert(std::move(node));
+            if (!result.inserted) result.position->second = obj;
+        }
+        spawnQueue.clear();
+    }
+
+    // Two-phase update: entities first update themselves and AI targeting/steering runs in
+    // parallel over a read-only view, then the resulting intents are applied to the bodies
+    // and the world serially, in id order.
+    // Advances the simulation by one fixed step of clock
+    void Update() {
+        clock.Advance();
+        float dt = (float)clock.Step();
+        double now = clock.Now();
+        UpdateActivity(dt);
+        {
+            TickProfiler::Scope scope(profiler, TickProfiler::PHYSICS);
+            PhysicsSpace::Step(space, threadedSolver, dt);
+            EnforceMapBoundaries();
+        }
+
+        for (auto& [id, obj] : objects) {
+            if (!obj->tickDue) continue;
+            obj->Update(obj->idleDt, now);
+            obj->idleDt = 0.0f;
+            if (obj->destroyFlag) Despawn(obj);
 
                         if (obj->type == EntityType::PLAYER) {
                 auto p = std::dynamic_pointer_cast<Player>(obj);
@@ -238,81 +373,178 @@ public:
                     p->spawnBulletSignal = false;
                     Vector2 playerPos = ToRay(cpBodyGetPosition(p->body));
                     Vector2 dir = Vector2Normalize(p->bulletDir);
-                    auto b = std::make_shared<Bullet>(nextId++, Vector2Add(playerPos, Vector2Scale(dir, 35.0f)), dir, p->id, space);
-
-                    b->lifeTime = p->curBulletPen;
-                    float spd = p->curBulletSpeed;
-
-                                        cpBodySetVelocity(b->body, cpvadd(cpvmult(ToCp(dir), spd), cpvmult(cpBodyGetVelocity(p->body), 0.2f)));
-                    newBullets.push_back(b);
+                    Vector2 vel = Vector2Add(Vector2Scale(dir, p->curBulletSpeed), Vector2Scale(ToRay(cpBodyGetVelocity(p->body)), 0.2f));
+                    projectiles.Spawn(NewId(), Vector2Add(playerPos, Vector2Scale(dir, 35.0f)), vel, p->curBulletPen, p->id);
                 }
             }
+        }
 
-                        if (obj->type == EntityType::TURRET) {
-                auto t = std::dynamic_pointer_cast<Turret>(obj);
-                if (t->cooldown <= 0) {
-                    float minDist = t->range;
-                    std::shared_ptr<GameObject> target = nullptr;
-                    Vector2 tPos = ToRay(cpBodyGetPosition(t->body));
-
-                                        for (auto& [eid, eObj] : objects) {
-                        if (eObj->type == EntityType::ENEMY) {
-                            float d = Vector2Distance(tPos, ToRay(cpBodyGetPosition(eObj->body)));
-                            if (d < minDist) { minDist = d; target = eObj; }
-                        }
-                    }
+        {
+            TickProfiler::Scope scope(profiler, TickProfiler::AI);
+            BuildAiView();
+            ComputeAiIntents();
+            ApplyAiIntents();
+        }
 
-                    if (target) {
-                        t->cooldown = t->reloadTime;
-                        Vector2 ePos = ToRay(cpBodyGetPosition(target->body));
-                        Vector2 dir = Vector2Normalize(Vector2Subtract(ePos, tPos));
-                        auto b = std::make_shared<Bullet>(nextId++, Vector2Add(tPos, Vector2Scale(dir, 35.0f)), dir, t->ownerId, space);
-                        newBullets.push_back(b);
-                    }
-                }
+        projectiles.Advance(dt);
+
+        {
+            TickProfiler::Scope scope(profiler, TickProfiler::COLLISIONS);
+            HandleCollisionsAndDamage();
+        }
+        FlushCommands();
+
+        for (auto& [id, obj] : objects) {
+            if (obj->type == EntityType::PLAYER) static_cast<Player*>(obj.get())->CommitStats();
+        }
+    }
+
+    // Players, turrets and anything near a player are ACTIVE. Enemies farther than
+    // dormancyRadius from every player are DORMANT and update every dormantTickInterval
+    // ticks (staggered by id) with the time they skipped. Undamaged walls and mines without
+    // a lifetime, and artifacts with no player nearby, are ASLEEP.
+    void UpdateActivity(float dt) {
+        activityPlayers.clear();
+        for (auto& [id, obj] : objects) {
+            if (obj->type == EntityType::PLAYER && !obj->destroyFlag) activityPlayers.push_back(ToRay(cpBodyGetPosition(obj->body)));
+        }
+
+        float radiusSq = dormancyRadius * dormancyRadius;
+        auto nearPlayer = [&](const GameObject* obj) {
+            Vector2 pos = ToRay(cpBodyGetPosition(obj->body));
+            for (const Vector2& p : activityPlayers) {
+                float dx = pos.x - p.x, dy = pos.y - p.y;
+                if (dx * dx + dy * dy <= radiusSq) return true;
             }
+            return false;
+        };
 
-                        if (obj->type == EntityType::MINE) {
-                auto m = std::dynamic_pointer_cast<Mine>(obj);
-                Vector2 mPos = ToRay(cpBodyGetPosition(m->body));
-                for (auto& [eid, eObj] : objects) {
-                    if (eObj->type == EntityType::ENEMY) {
-                        if (Vector2Distance(mPos, ToRay(cpBodyGetPosition(eObj->body))) < 35.0f) {
-                            pendingEvents.push_back({ 1, mPos, ORANGE });
-                            eObj->TakeDamage(m->damage, GetTime());
-                            m->destroyFlag = true;
-                            break;
-                        }
-                    }
-                }
+        size_t dormant = 0;
+        for (auto& [id, obj] : objects) {
+            obj->idleDt += dt;
+            switch (obj->type) {
+            case EntityType::ENEMY:
+                obj->activity = nearPlayer(obj.get()) ? GameObject::ACTIVE : GameObject::DORMANT;
+                break;
+            case EntityType::WALL:
+            case EntityType::MINE: {
+                auto c = static_cast<Construct*>(obj.get());
+                obj->activity = (c->lifetime > 0 || c->health < c->maxHealth) ? GameObject::ACTIVE : GameObject::ASLEEP;
+            } break;
+            case EntityType::ARTIFACT:
+                obj->activity = nearPlayer(obj.get()) ? GameObject::ACTIVE : GameObject::ASLEEP;
+                break;
+            default:
+                obj->activity = GameObject::ACTIVE;
+                break;
             }
 
-                        if (obj->type == EntityType::ENEMY) {
-                auto enemy = std::dynamic_pointer_cast<Enemy>(obj);
+            if (obj->activity == GameObject::DORMANT) obj->tickDue = (clock.Tick() + id) % dormantTickInterval == 0;
+            else obj->tickDue = obj->activity == GameObject::ACTIVE;
+            if (obj->activity != GameObject::ACTIVE) dormant++;
+        }
+        profiler.AddActivity(dormant, objects.size());
+    }
+
+    void BuildAiView() {
+        ai.enemies.clear(); ai.enemyPos.clear(); ai.enemyVel.clear(); ai.enemySteer.clear();
+        ai.targetPos.clear();
+        ai.turrets.clear(); ai.turretPos.clear();
+        ai.mines.clear(); ai.minePos.clear();
+
+        for (auto& [id, obj] : objects) {
+            if (obj->destroyFlag) continue;
+            switch (obj->type) {
+            case EntityType::ENEMY:
+                ai.enemies.push_back(static_cast<Enemy*>(obj.get()));
+                ai.enemyPos.push_back(ToRay(cpBodyGetPosition(obj->body)));
+                ai.enemyVel.push_back(cpBodyGetVelocity(obj->body));
+                ai.enemySteer.push_back(obj->tickDue);
+                break;
+            case EntityType::PLAYER:
+                ai.targetPos.push_back(ToRay(cpBodyGetPosition(obj->body)));
+                break;
+            case EntityType::TURRET: {
+                Vector2 pos = ToRay(cpBodyGetPosition(obj->body));
+                ai.targetPos.push_back(pos);
+                auto t = static_cast<Turret*>(obj.get());
+                if (t->cooldown <= 0) { ai.turrets.push_back(t); ai.turretPos.push_back(pos); }
+            } break;
+            case EntityType::MINE:
+                ai.mines.push_back(static_cast<Mine*>(obj.get()));
+                ai.minePos.push_back(ToRay(cpBodyGetPosition(obj->body)));
+                break;
+            default: break;
+            }
+        }
+
+        ai.steering.resize(ai.enemies.size());
+        ai.turretTarget.assign(ai.turrets.size(), -1);
+        ai.mineTarget.assign(ai.mines.size(), -1);
+    }
+
+    void ComputeAiIntents() {
+        Vector2 center = { width / 2, height / 2 };
+        jobs.ParallelFor(ai.enemies.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                if (!ai.enemySteer[i]) continue;
                 float minDist = 999999.0f;
-                Vector2 targetPos = { width / 2, height / 2 };
-                Vector2 myPos = ToRay(cpBodyGetPosition(obj->body));
+                Vector2 targetPos = center;
+                for (const Vector2& pos : ai.targetPos) {
+                    float dist = Vector2Distance(ai.enemyPos[i], pos);
+                    if (dist < minDist) { minDist = dist; targetPos = pos; }
+                }
+                ai.steering[i] = ai.enemies[i]->Steer(ai.enemyPos[i], ai.enemyVel[i], targetPos);
+            }
+        });
+
+        jobs.ParallelFor(ai.turrets.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                float minDist = ai.turrets[i]->range;
+                for (size_t e = 0; e < ai.enemyPos.size(); e++) {
+                    float d = Vector2Distance(ai.turretPos[i], ai.enemyPos[e]);
+                    if (d < minDist) { minDist = d; ai.turretTarget[i] = (int)e; }
+                }
+            }
+        });
 
-                for (const auto& [pid, pObj] : objects) {
-                    if (pObj->type == EntityType::PLAYER || pObj->type == EntityType::TURRET) {
-                        float dist = Vector2Distance(myPos, ToRay(cpBodyGetPosition(pObj->body)));
-                        if (dist < minDist) { minDist = dist; targetPos = ToRay(cpBodyGetPosition(pObj->body)); }
-                    }
+        jobs.ParallelFor(ai.mines.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                for (size_t e = 0; e < ai.enemyPos.size(); e++) {
+                    if (Vector2Distance(ai.minePos[i], ai.enemyPos[e]) < 35.0f) { ai.mineTarget[i] = (int)e; break; }
                 }
-                enemy->MoveTowards(targetPos);
             }
+        });
+    }
 
-            if (obj->destroyFlag) it = objects.erase(it);
-            else ++it;
+    void ApplyAiIntents() {
+        for (size_t i = 0; i < ai.enemies.size(); i++) {
+            if (ai.enemySteer[i]) ai.enemies[i]->ApplySteering(ai.steering[i]);
         }
-        for (auto& b : newBullets) objects[b->id] = b;
 
-        HandleCollisionsAndDamage();
+        for (size_t i = 0; i < ai.turrets.size(); i++) {
+            if (ai.turretTarget[i] < 0) continue;
+            Turret* t = ai.turrets[i];
+            Vector2 tPos = ai.turretPos[i];
+            t->cooldown = t->reloadTime;
+            Vector2 ePos = ai.enemyPos[ai.turretTarget[i]];
+            Vector2 dir = Vector2Normalize(Vector2Subtract(ePos, tPos));
+            if (dir.x == 0 && dir.y == 0) dir = { 1.0f, 0.0f };
+            projectiles.Spawn(NewId(), Vector2Add(tPos, Vector2Scale(dir, 35.0f)), Vector2Scale(dir, TURRET_BULLET_SPEED), TURRET_BULLET_LIFETIME, t->ownerId);
+        }
+
+        for (size_t i = 0; i < ai.mines.size(); i++) {
+            if (ai.mineTarget[i] < 0) continue;
+            Mine* m = ai.mines[i];
+            pendingEvents.push_back({ 1, ai.minePos[i], ORANGE });
+            ai.enemies[ai.mineTarget[i]]->TakeDamage(m->damage, clock.Now());
+            Despawn(m->id);
+        }
     }
 
     void EnforceMapBoundaries() {
         for (auto& [id, obj] : objects) {
-                        if (obj->type == EntityType::BULLET || !obj->body || cpBodyGetType(obj->body) == CP_BODY_TYPE_STATIC) continue;
+            if (obj->activity == GameObject::ASLEEP || !obj->body || cpBodyGetType(obj->body) == CP_BODY_TYPE_STATIC) continue;
 
             cpVect pos = cpBodyGetPosition(obj->body);
             cpVect vel = cpBodyGetVelocity(obj->body);
@@ -328,29 +560,26 @@ public:
         }
     }
     void HandleCollisionsAndDamage() {
-        std::vector<std::shared_ptr<GameObject>> newArtifacts;
-        double currentTime = GetTime();
+        double currentTime = clock.Now();
 
                 std::vector<std::shared_ptr<Enemy>> enemies;
         std::vector<std::shared_ptr<Player>> players;
-        std::vector<std::shared_ptr<Bullet>> bullets;
         std::vector<std::shared_ptr<Construct>> structures;
         std::vector<std::shared_ptr<Mine>> mines;
         std::vector<std::shared_ptr<Artifact>> artifacts;
 
         enemies.reserve(objects.size());
-        bullets.reserve(objects.size());
 
         for (auto& [id, obj] : objects) {
             if (obj->destroyFlag) continue;
             switch (obj->type) {
             case EntityType::ENEMY: enemies.push_back(std::dynamic_pointer_cast<Enemy>(obj)); break;
             case EntityType::PLAYER: players.push_back(std::dynamic_pointer_cast<Player>(obj)); break;
-            case EntityType::BULLET: bullets.push_back(std::dynamic_pointer_cast<Bullet>(obj)); break;
             case EntityType::WALL:
             case EntityType::TURRET: structures.push_back(std::dynamic_pointer_cast<Construct>(obj)); break;
             case EntityType::MINE: mines.push_back(std::dynamic_pointer_cast<Mine>(obj)); break;
             case EntityType::ARTIFACT: artifacts.push_back(std::dynamic_pointer_cast<Artifact>(obj)); break;
+            default: break;
             }
         }
 
@@ -385,7 +614,7 @@ public:
                 if (Vector2Distance(ePos, sPos) < (eRad + sRad + 8.0f)) {
                     str->TakeDamage(enemy->damage * 2.0f * 0.016f, currentTime);
                     if (str->health <= 0) {
-                        str->destroyFlag = true;
+                        Despawn(str);
                         pendingEvents.push_back({ 1, sPos, GRAY });
                     }
                     enemy->TakeDamage(5.0f * 0.016f, currentTime);
@@ -404,7 +633,7 @@ public:
                 }
             }
             if (triggered) {
-                mine->destroyFlag = true;
+                Despawn(mine);
                 pendingEvents.push_back({ 1, mPos, ORANGE });
                 pendingEvents.push_back({ 2, mPos, RED });
                 for (auto& enemy : enemies) {
@@ -412,11 +641,11 @@ public:
                     if (Vector2Distance(mPos, ToRay(cpBodyGetPosition(enemy->body))) <= mine->splashRadius) {
                         enemy->TakeDamage(mine->damage, currentTime);
                         if (enemy->health <= 0) {
-                            enemy->destroyFlag = true;
+                            Despawn(enemy);
                             pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(enemy->body)), RED });
                             if (objects.count(mine->ownerId) && objects[mine->ownerId]->type == EntityType::PLAYER) {
                                 auto p = std::dynamic_pointer_cast<Player>(objects[mine->ownerId]);
-                                p->AddXp(enemy->xpReward); p->scrap += enemy->scrapReward; p->kills++;
+                                p->AddXp(enemy->xpReward); p->AddScrap(enemy->scrapReward); p->AddKill();
                             }
                         }
                     }
@@ -425,107 +654,106 @@ public:
         }
 
                 for (auto& art : artifacts) {
-            if (art->destroyFlag) continue;
+            if (art->destroyFlag || art->activity == GameObject::ASLEEP) continue;
             Vector2 aPos = ToRay(cpBodyGetPosition(art->body));
             for (auto& p : players) {
                 if (Vector2Distance(aPos, ToRay(cpBodyGetPosition(p->body))) < 40.0f) {
                     if (p->AddItemToInventory(art->bonusType)) {
-                        art->destroyFlag = true;
+                        Despawn(art);
                         pendingEvents.push_back({ 2, aPos, GOLD });
                     }
                 }
             }
         }
 
-                for (auto& bullet : bullets) {
-            if (bullet->destroyFlag) continue;
-            Vector2 bPos = ToRay(cpBodyGetPosition(bullet->body));
+        ResolveProjectileHits(enemies, players, structures, currentTime);
+    }
 
-            if (bPos.x <= -50 || bPos.x >= width + 50 || bPos.y <= -50 || bPos.y >= height + 50) {
-                bullet->destroyFlag = true; continue;
-            }
+    // Each projectile's swept segment for this tick is tested against enemies first, then
+    // players (PvP), then structures; within a group the first circle it enters is hit
+    void ResolveProjectileHits(const std::vector<std::shared_ptr<Enemy>>& enemies, const std::vector<std::shared_ptr<Player>>& players,
+        const std::vector<std::shared_ptr<Construct>>& structures, double currentTime) {
+        enemyGrid.Clear();
+        for (uint32_t i = 0; i < enemies.size(); i++) {
+            float targetRadius = (enemies[i]->enemyType == EnemyType::BOSS) ? 75.0f : ((enemies[i]->enemyType == EnemyType::TANK) ? 40.0f : 30.0f);
+            enemyGrid.Insert(ToRay(cpBodyGetPosition(enemies[i]->body)), targetRadius, i);
+        }
+        playerGrid.Clear();
+        for (uint32_t i = 0; i < players.size(); i++) playerGrid.Insert(ToRay(cpBodyGetPosition(players[i]->body)), 25.0f, i);
+        structureGrid.Clear();
+        for (uint32_t i = 0; i < structures.size(); i++) {
+            float sRad = (structures[i]->type == EntityType::WALL) ? 35.0f : 25.0f;
+            structureGrid.Insert(ToRay(cpBodyGetPosition(structures[i]->body)), sRad, i);
+        }
 
-            bool hit = false;
-            float dmg = 10.0f;
+        for (size_t i = 0; i < projectiles.Size(); i++) {
+            if (projectiles.dead[i]) continue;
+            Vector2 from = projectiles.previous[i];
+            Vector2 bPos = projectiles.positions[i];
+            uint32_t ownerId = projectiles.owners[i];
 
-                        if (objects.count(bullet->ownerId)) {
-                auto owner = objects[bullet->ownerId];
-                if (owner->type == EntityType::PLAYER) dmg = std::dynamic_pointer_cast<Player>(owner)->curDamage;
-                else if (owner->type == EntityType::TURRET) dmg = std::dynamic_pointer_cast<Turret>(owner)->damage;
+            if (bPos.x <= -50 || bPos.x >= width + 50 || bPos.y <= -50 || bPos.y >= height + 50) {
+                projectiles.Kill(i); continue;
             }
 
-                        for (auto& enemy : enemies) {
-                if (enemy->destroyFlag || enemy->health <= 0) continue;
-                float targetRadius = (enemy->enemyType == EnemyType::BOSS) ? 75.0f : ((enemy->enemyType == EnemyType::TANK) ? 40.0f : 30.0f);
-
-                if (Vector2Distance(bPos, ToRay(cpBodyGetPosition(enemy->body))) <= targetRadius) {
-                    hit = true;
-                    enemy->TakeDamage(dmg, currentTime);
-                    if (enemy->health <= 0) {
-                        enemy->destroyFlag = true;
-                        pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(enemy->body)), RED });
-                        if (objects.count(bullet->ownerId) && objects[bullet->ownerId]->type == EntityType::PLAYER) {
-                            auto p = std::dynamic_pointer_cast<Player>(objects[bullet->ownerId]);
-                            p->AddXp(enemy->xpReward); p->scrap += enemy->scrapReward; p->kills++;
-                        }
-                        int dropChance = (enemy->enemyType == EnemyType::BOSS) ? 100 : (enemy->enemyType == EnemyType::TANK ? 25 : 5);
-                        if (rand() % 100 < dropChance) newArtifacts.push_back(std::make_shared<Artifact>(nextId++, ToRay(cpBodyGetPosition(enemy->body)), space));
-                    }
-                    break;
+            float dmg = 10.0f;
+            auto ownerIt = objects.find(ownerId);
+            std::shared_ptr<GameObject> owner = (ownerIt != objects.end()) ? ownerIt->second : nullptr;
+            std::shared_ptr<Player> ownerPlayer = (owner && owner->type == EntityType::PLAYER) ? std::dynamic_pointer_cast<Player>(owner) : nullptr;
+            if (ownerPlayer) dmg = ownerPlayer->curDamage;
+            else if (owner && owner->type == EntityType::TURRET) dmg = std::dynamic_pointer_cast<Turret>(owner)->damage;
+
+            Vector2 hitPos;
+            int e = enemyGrid.FirstHit(from, bPos, [&](uint32_t k) { return !enemies[k]->destroyFlag && enemies[k]->health > 0; }, hitPos);
+            if (e >= 0) {
+                auto& enemy = enemies[e];
+                enemy->TakeDamage(dmg, currentTime);
+                if (enemy->health <= 0) {
+                    Despawn(enemy);
+                    pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(enemy->body)), RED });
+                    if (ownerPlayer) { ownerPlayer->AddXp(enemy->xpReward); ownerPlayer->AddScrap(enemy->scrapReward); ownerPlayer->AddKill(); }
+                    int dropChance = (enemy->enemyType == EnemyType::BOSS) ? 100 : (enemy->enemyType == EnemyType::TANK ? 25 : 5);
+                    if (rand() % 100 < dropChance) Spawn(std::make_shared<Artifact>(NewId(), ToRay(cpBodyGetPosition(enemy->body)), space));
                 }
+                projectiles.Kill(i); pendingEvents.push_back({ 0, hitPos, WHITE }); continue;
             }
-            if (hit) { bullet->destroyFlag = true; pendingEvents.push_back({ 0, bPos, WHITE }); continue; }
-
-                        if (pvpFactor > 0.001f) {                 for (auto& p : players) {
-                                        if (p->id == bullet->ownerId) continue;
-                    if (p->destroyFlag || p->health <= 0) continue;
-
-                                                            if (objects.count(bullet->ownerId) && objects[bullet->ownerId]->type != EntityType::PLAYER) continue;
-
-                    float pRad = 25.0f;
-                    if (Vector2Distance(bPos, ToRay(cpBodyGetPosition(p->body))) <= pRad) {
-                        hit = true;
-
-                                                float pvpDmg = dmg * pvpFactor;
-
-                        p->TakeDamage(pvpDmg, currentTime);
-                        pendingEvents.push_back({ 0, bPos, RED }); 
-                        if (p->health <= 0) {
-                            p->Reset();
-                            cpBodySetPosition(p->body, cpv(rand() % (int)width, rand() % (int)height));
-                            pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(p->body)), RED });
 
-                                                        if (objects.count(bullet->ownerId) && objects[bullet->ownerId]->type == EntityType::PLAYER) {
-                                auto killer = std::dynamic_pointer_cast<Player>(objects[bullet->ownerId]);
-                                killer->kills++;
-                                killer->scrap += p->level * 10;                             }
-                        }
-                        break;
+            // Turret bullets never hit players
+            if (pvpFactor > 0.001f && (!owner || ownerPlayer)) {
+                int t = playerGrid.FirstHit(from, bPos, [&](uint32_t k) {
+                    return players[k]->id != ownerId && !players[k]->destroyFlag && players[k]->health > 0;
+                    }, hitPos);
+                if (t >= 0) {
+                    auto& p = players[t];
+                    p->TakeDamage(dmg * pvpFactor, currentTime);
+                    pendingEvents.push_back({ 0, hitPos, RED });
+                    if (p->health <= 0) {
+                        p->Reset();
+                        cpBodySetPosition(p->body, cpv(rand() % (int)width, rand() % (int)height));
+                        pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(p->body)), RED });
+                        if (ownerPlayer) { ownerPlayer->AddKill(); ownerPlayer->AddScrap(p->level * 10); }
                     }
+                    projectiles.Kill(i); continue;
                 }
             }
-            if (hit) { bullet->destroyFlag = true; continue; }
-
-                                    for (auto& str : structures) {
-                if (str->destroyFlag) continue;
-                if (str->ownerId == bullet->ownerId) continue; 
-                                if (pvpFactor <= 0.001f && objects.count(bullet->ownerId) && objects[bullet->ownerId]->type == EntityType::PLAYER) continue;
 
-                float sRad = (str->type == EntityType::WALL) ? 35.0f : 25.0f;
-                if (Vector2Distance(bPos, ToRay(cpBodyGetPosition(str->body))) <= sRad) {
-                    hit = true;
-                                        str->TakeDamage(dmg, currentTime);
-                    if (str->health <= 0) {
-                        str->destroyFlag = true;
-                        pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(str->body)), GRAY });
-                    }
-                    break;
+            if (pvpFactor <= 0.001f && ownerPlayer) continue;
+            int s = structureGrid.FirstHit(from, bPos, [&](uint32_t k) {
+                return !structures[k]->destroyFlag && structures[k]->ownerId != ownerId;
+                }, hitPos);
+            if (s >= 0) {
+                auto& str = structures[s];
+                str->TakeDamage(dmg, currentTime);
+                if (str->health <= 0) {
+                    Despawn(str);
+                    pendingEvents.push_back({ 1, ToRay(cpBodyGetPosition(str->body)), GRAY });
                 }
+                projectiles.Kill(i); pendingEvents.push_back({ 0, hitPos, WHITE });
             }
-            if (hit) { bullet->destroyFlag = true; pendingEvents.push_back({ 0, bPos, WHITE }); continue; }
         }
-
-        for (auto& a : newArtifacts) objects[a->id] = a;
+        removedProjectileIds.clear();
+        projectiles.RemoveDead(removedProjectileIds);
+        for (uint32_t id : removedProjectileIds) entityIds.Release(id, currentTime);
     }
 
 };
\ No newline at end of file
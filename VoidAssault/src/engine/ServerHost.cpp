@@ -5,16 +5,13 @@
 #include <chrono>
 #include <cmath>
 #include <algorithm>
+#include <unordered_set>
 #include "Utils/ConfigManager.h"
 #include "common/CompressionHelper.h"
 #if defined(__linux__) || defined(__APPLE__)
 #include <signal.h>
 #endif
 
-static bool IsRelayClient(uint32_t id, const std::vector<uint32_t>& relayIds) {
-    return std::find(relayIds.begin(), relayIds.end(), id) != relayIds.end();
-}
-
 double GetSystemTime() {
     static auto start = std::chrono::high_resolution_clock::now();
     auto now = std::chrono::high_resolution_clock::now();
@@ -40,6 +37,15 @@ bool ServerHost::Start(int port, bool registerOnMaster = true) {
 
     ServerConfig& cfg = ConfigManager::GetServer();
     gameScene.pvpFactor = cfg.pvpDamageFactor;
+    gameScene.ConfigureJobs(cfg.simulationThreads, cfg.deterministicSimulation);
+    PhysicsSettings physics;
+    physics.iterations = cfg.physicsIterations;
+    physics.solverThreads = cfg.physicsThreads;
+    physics.spatialHash = cfg.physicsSpatialHash;
+    physics.hashCellSize = cfg.physicsHashCellSize;
+    gameScene.ConfigurePhysics(physics);
+    gameScene.ConfigureDormancy(cfg.dormancyRadius, cfg.dormantTickInterval);
+    snapshotScheduler.Configure(cfg.snapshotRate, cfg.minSnapshotRate, cfg.clientBytesPerSecond, cfg.snapshotMtu);
     useMasterServer = registerOnMaster;
     if (!netServer->start(port, cfg.maxPlayers)) return false;
 
@@ -56,35 +62,52 @@ void ServerHost::Stop() {
     if (serverThread.joinable()) serverThread.join();
     netServer->stop();
     if (masterClient) masterClient->disconnect();
-    relayClientIds.clear();
+    peers.Clear();
+    relayEncoders.clear();
+    snapshotScheduler.Clear();
 }
 
-void ServerHost::RegisterWithMaster() {
+void ServerHost::RegisterWithMaster(int port) {
     if (!useMasterServer) return;
     ClientConfig& cCfg = ConfigManager::GetClient();
-    ServerConfig& sCfg = ConfigManager::GetServer();
 
-    if (masterClient->connect(cCfg.masterServerIp, cCfg.masterServerPort)) {
-        std::cout << "SERVER: Connected to Master Server at " << cCfg.masterServerIp << ":" << cCfg.masterServerPort << "\n";
-        connectedToMaster = true;
-
-        Buffer buffer; OutputAdapter adapter(buffer);
-        bitsery::Serializer<OutputAdapter> serializer(std::move(adapter));
-        serializer.value1b(GamePacket::MASTER_REGISTER);
+    // Non-blocking: MASTER_REGISTER is sent from the CONNECT event, and a failed attempt is
+    // retried by UpdateMasterReconnect
+    masterPort = port;
+    connectedToMaster = false;
+    masterReconnectTimer = MASTER_RECONNECT_DELAY;
+    std::cout << "SERVER: Connecting to Master Server at " << cCfg.masterServerIp << ":" << port << "\n";
+    masterClient->connectAsync(cCfg.masterServerIp, port);
+}
 
-        MasterRegisterPacket pkt;
-        pkt.gamePort = (uint16_t)ConfigManager::GetServer().port;
-        pkt.serverName = sCfg.serverName;
-        pkt.maxPlayers = (uint8_t)sCfg.maxPlayers;
+void ServerHost::SendMasterRegister() {
+    ServerConfig& sCfg = ConfigManager::GetServer();
+    Buffer buffer; OutputAdapter adapter(buffer);
+    bitsery::Serializer<OutputAdapter> serializer(std::move(adapter));
+    serializer.value1b(GamePacket::MASTER_REGISTER);
+
+    MasterRegisterPacket pkt;
+    pkt.gamePort = (uint16_t)ConfigManager::GetServer().port;
+    pkt.serverName = sCfg.serverName;
+    pkt.maxPlayers = (uint8_t)sCfg.maxPlayers;
+
+    serializer.object(pkt);
+    serializer.adapter().flush();
+    masterClient->send(DeliveryType::RELIABLE, StreamBuffer::alloc(buffer.data(), buffer.size()));
+}
 
-        serializer.object(pkt);
-        serializer.adapter().flush();
-        masterClient->send(DeliveryType::RELIABLE, StreamBuffer::alloc(buffer.data(), buffer.size()));
-    }
-    else {
-        std::cout << "SERVER: Failed to connect to Master Server (Relay unavailable).\n";
-        connectedToMaster = false;
-    }
+// Reconnects without blocking the tick loop; registering again lets a restarted master
+// hand back the lobby it restored from its snapshot. Retries go through the entry port,
+// since a shard we were redirected to may not exist after a master restart; the master
+// redirects us again if the lobby belongs to another shard.
+void ServerHost::UpdateMasterReconnect(double dt) {
+    if (!useMasterServer || connectedToMaster || masterClient->isConnecting()) return;
+    masterReconnectTimer -= dt;
+    if (masterReconnectTimer > 0.0) return;
+    masterReconnectTimer = MASTER_RECONNECT_DELAY;
+    ClientConfig& cCfg = ConfigManager::GetClient();
+    masterPort = cCfg.masterServerPort;
+    masterClient->connectAsync(cCfg.masterServerIp, masterPort);
 }
 
 void ServerHost::UpdateMasterHeartbeat(float dt) {
@@ -105,7 +128,7 @@ void ServerHost::UpdateMasterHeartbeat(float dt) {
 
         MasterHeartbeatPacket pkt;
         pkt.currentPlayers = (uint8_t)playerCount;
-        pkt.wave = (uint8_t)waveCount;
+        pkt.wave = (uint8_t)waves.wave;
 
         serializer.object(pkt);
         serializer.adapter().flush();
@@ -114,28 +137,32 @@ void ServerHost::UpdateMasterHeartbeat(float dt) {
 }
 
 void ServerHost::SendToClient(uint32_t peerId, DeliveryType type, StreamBuffer::Shared stream) {
-    if (IsRelayClient(peerId, relayClientIds)) {
+    if (peers.IsRelay(peerId)) {
         RelayPacket rp;
         rp.targetId = peerId;
-        rp.isReliable = (type == DeliveryType::RELIABLE);
+        bool reliable = (type == DeliveryType::RELIABLE);
 
         const auto& rawData = stream->buffer();
 
-        if (rawData.size() > 128) {
-            std::vector<uint8_t> compressed = CompressionHelper::Compress(rawData);
-            if (!compressed.empty()) {
-                rp.data = std::move(compressed);
-                rp.isCompressed = true;
-            }
-            else {
-                rp.data = rawData;
-                rp.isCompressed = false;
-            }
+        auto& encoder = relayEncoders[peerId];
+        if (!encoder) encoder = std::make_unique<RelayStreamEncoder>();
+        std::vector<uint8_t> compressed = encoder->Encode(rawData, reliable, RELAY_MAX_PAYLOAD_BYTES);
+        if (!compressed.empty()) {
+            rp.data = std::move(compressed);
+            rp.compression = RelayCompression::STREAM;
         }
         else {
+            // The master won't forward it; the encoder state is untouched, so the stream survives
+            if (rawData.size() > RELAY_MAX_PAYLOAD_BYTES) {
+                std::cout << "[Relay] Dropped " << rawData.size() << " byte packet for client " << peerId << "\n";
+                return;
+            }
             rp.data = rawData;
-            rp.isCompressed = false;
+            rp.compression = RelayCompression::NONE;
         }
+        // Keyframes of the unreliable stream are sent reliably so later deltas can be decoded
+        type = reliable ? DeliveryType::RELIABLE : DeliveryType::UNRELIABLE;
+        rp.isReliable = reliable;
 
         Buffer buf;
         OutputAdapter ad(buf);
@@ -164,6 +191,10 @@ void ServerHost::ProcessGamePacket(uint32_t peerId, StreamBuffer::Shared stream)
     if (type == GamePacket::JOIN) {
         JoinPacket pkt; des.object(pkt);
         if (des.adapter().error() == bitsery::ReaderError::NoError) {
+            // A JOIN starts a new relay session, which may reuse the id of an earlier one
+            auto encoder = relayEncoders.find(peerId);
+            if (encoder != relayEncoders.end()) encoder->second->Reset();
+
             if (!gameScene.objects.count(peerId)) {
                 std::cout << "Client joined (ID: " << peerId << ")\n";
                 auto player = gameScene.CreatePlayerWithId(peerId);
@@ -215,15 +246,18 @@ void ServerHost::ServerLoop() {
     double accumulator = 0.0;
     int tickRate = ConfigManager::GetServer().tickRate;
     double dt = 1.0 / (double)tickRate;
+    gameScene.clock.SetTickRate(tickRate);
 
-    double snapshotTimer = 0.0;
+    double linkStatsTimer = 0.0;
     double statsTimer = 0.0;
+    double profileTimer = 0.0;
+    int profileInterval = ConfigManager::GetServer().profileInterval;
 
-    waveCount = 1;
-    waveTimer = 0.0;
-    timeToNextWave = 5.0;
+    const ServerConfig& cfg = ConfigManager::GetServer();
+    waves.Configure(tickRate, cfg.waveSpawnsPerTick, cfg.minEnemyCap, cfg.maxEnemyCap);
+    waves.Reset();
 
-    RegisterWithMaster();
+    RegisterWithMaster(ConfigManager::GetClient().masterServerPort);
 
     while (running) {
         if (!netServer->isRunning()) break;
@@ -243,10 +277,14 @@ void ServerHost::ServerLoop() {
                 Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
                 ser.value1b(GamePacket::INIT); ser.object(initPkt); ser.adapter().flush();
                 netServer->send(peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
+                peers.Add(peerId, PeerTable::Transport::DIRECT);
+                snapshotScheduler.AddClient(peerId);
             }
             else if (msg->type() == MessageType::DISCONNECT) {
                 std::cout << "Direct Client " << peerId << " disconnected.\n";
-                gameScene.objects.erase(peerId);
+                gameScene.Despawn(peerId);
+                peers.Remove(peerId);
+                snapshotScheduler.RemoveClient(peerId);
             }
             else if (msg->type() == MessageType::DATA) {
                 ProcessGamePacket(peerId, msg->stream());
@@ -254,10 +292,16 @@ void ServerHost::ServerLoop() {
         }
 
         UpdateMasterHeartbeat((float)frameTime);
+        UpdateMasterReconnect(frameTime);
         if (masterClient) {
             auto masterMsgs = masterClient->poll();
             for (auto& msg : masterMsgs) {
-                if (msg->type() == MessageType::DATA) {
+                if (msg->type() == MessageType::CONNECT && !connectedToMaster) {
+                    std::cout << "SERVER: Connected to Master Server on port " << masterPort << "\n";
+                    connectedToMaster = true;
+                    SendMasterRegister();
+                }
+                else if (msg->type() == MessageType::DATA) {
                     const auto& buf = msg->stream()->buffer();
                     size_t offset = msg->stream()->tellg();
                     if (!buf.empty()) {
@@ -270,120 +314,220 @@ void ServerHost::ServerLoop() {
                             if (des.adapter().error() == bitsery::ReaderError::NoError) {
                                 uint32_t relayId = rp.targetId;
 
-                                if (!IsRelayClient(relayId, relayClientIds)) {
-                                    relayClientIds.push_back(relayId);
+                                if (peers.Add(relayId, PeerTable::Transport::RELAY)) {
+                                    snapshotScheduler.AddClient(relayId);
                                     std::cout << "Relay Client " << relayId << " registered.\n";
                                 }
                                 auto innerStream = StreamBuffer::alloc(rp.data.data(), rp.data.size());
                                 ProcessGamePacket(relayId, innerStream);
                             }
                         }
+                        else if (type == GamePacket::MASTER_REDIRECT) {
+                            MasterRedirectPacket redirect; des.object(redirect);
+                            if (des.adapter().error() == bitsery::ReaderError::NoError) {
+                                std::cout << "SERVER: Master moved this lobby to port " << redirect.port << "\n";
+                                masterClient->disconnectNow();
+                                RegisterWithMaster(redirect.port);
+                            }
+                        }
                     }
                 }
                 else if (msg->type() == MessageType::DISCONNECT) {
+                    if (!connectedToMaster) continue;
                     std::cout << "Disconnected from Master Server (Relay lost).\n";
                     connectedToMaster = false;
-                    for (uint32_t rid : relayClientIds) gameScene.objects.erase(rid);
-                    relayClientIds.clear();
+                    masterReconnectTimer = MASTER_RECONNECT_DELAY;
+                    for (uint32_t rid : peers.RemoveAll(PeerTable::Transport::RELAY)) {
+                        gameScene.Despawn(rid);
+                        snapshotScheduler.RemoveClient(rid);
+                    }
+                    relayEncoders.clear();
                 }
             }
         }
 
-        int totalClients = netServer->numClients() + (int)relayClientIds.size();
+        int totalClients = (int)peers.Size();
         if (totalClients == 0) {
             bool hasEntities = false;
             for (auto& pair : gameScene.objects) {
-                if (pair.second->type != EntityType::PLAYER && pair.second->type != EntityType::WALL) {
+                if (!pair.second->destroyFlag && pair.second->type != EntityType::PLAYER && pair.second->type != EntityType::WALL) {
                     hasEntities = true; break;
                 }
             }
-            if (waveCount > 1 || hasEntities) {
-                auto it = gameScene.objects.begin();
-                while (it != gameScene.objects.end()) {
-                    if (it->second->type == EntityType::ENEMY || it->second->type == EntityType::BULLET) it = gameScene.objects.erase(it);
-                    else ++it;
+            if (waves.wave > 1 || hasEntities) {
+                for (auto& [id, obj] : gameScene.objects) {
+                    if (obj->type == EntityType::ENEMY) gameScene.Despawn(obj);
                 }
-                waveCount = 1; waveTimer = 0;
+                gameScene.projectiles.Clear();
+                waves.Reset();
             }
         }
 
         accumulator += frameTime;
-        snapshotTimer += frameTime;
+        linkStatsTimer += frameTime;
+        snapshotScheduler.Advance(frameTime);
         statsTimer += frameTime;
-        waveTimer += frameTime;
-
-        if (waveTimer >= timeToNextWave && totalClients > 0) {
-            waveTimer = 0.0;
-            timeToNextWave = 20.0 + (waveCount * 2.0);
-            int currentEnemies = 0;
-            for (auto& [id, obj] : gameScene.objects) { if (obj->type == EntityType::ENEMY) currentEnemies++; }
-            if (currentEnemies < 120) {
-                int enemiesToSpawn = 5 + (waveCount * 2);
-                if (enemiesToSpawn > 60) enemiesToSpawn = 60;
-                for (int i = 0; i < enemiesToSpawn; i++) gameScene.SpawnEnemy();
-                if (waveCount % 5 == 0) gameScene.SpawnEnemy(EnemyType::BOSS);
-                waveCount++;
-            }
-        }
+        waves.Advance(frameTime, totalClients > 0, gameScene.numEnemies);
 
         int maxPhysicsSteps = 5;
         int steps = 0;
         while (accumulator >= dt && steps < maxPhysicsSteps) {
-            gameScene.Update((float)dt);
+            auto tickStart = clock::now();
+            int spawns = waves.SpawnBudget(gameScene.numEnemies);
+            for (int i = 0; i < spawns; i++) gameScene.SpawnEnemy(waves.NextSpawn());
+            gameScene.Update();
+            double tickSeconds = std::chrono::duration<double>(clock::now() - tickStart).count();
+            gameScene.profiler.AddTick(tickSeconds, gameScene.objects.size());
+            waves.ReportTick(tickSeconds * 1000.0, gameScene.objects.size());
             accumulator -= dt;
             steps++;
         }
         if (accumulator > dt) accumulator = 0.0;
 
-        if (!gameScene.pendingEvents.empty()) {
-            for (const auto& evt : gameScene.pendingEvents) {
-                Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-                ser.value1b(GamePacket::EVENT); ser.object(evt); ser.adapter().flush();
-                BroadcastToAll(DeliveryType::UNRELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
-            }
-            gameScene.pendingEvents.clear();
+        if (linkStatsTimer >= 1.0) {
+            ReportLinkStats();
+            linkStatsTimer = 0;
         }
 
-        if (snapshotTimer >= 0.033) {
+        {
+            TickProfiler::Scope scope(gameScene.profiler, TickProfiler::NETWORK);
             BroadcastSnapshot();
-            snapshotTimer = 0;
         }
 
-        if (statsTimer >= 0.2) {
+        profileTimer += frameTime;
+        if (profileInterval > 0 && profileTimer >= profileInterval) {
+            profileTimer = 0.0;
+            if (gameScene.profiler.Ticks() > 0) std::cout << "SERVER: Profile " << gameScene.profiler.Report(waves.wave) << "\n";
+            gameScene.profiler.Reset();
+        }
+
+        bool fullStatsRefresh = statsTimer >= 5.0;
+        if (fullStatsRefresh) statsTimer = 0;
+        if (steps > 0 || fullStatsRefresh) {
             for (auto& [id, obj] : gameScene.objects) {
-                if (obj->type == EntityType::PLAYER) {
-                    auto p = std::dynamic_pointer_cast<Player>(obj);
-                    PlayerStatsPacket stats;
-                    stats.level = p->level; stats.currentXp = p->currentXp; stats.maxXp = p->maxXp;
-                    stats.maxHealth = p->maxHealth; stats.damage = p->curDamage; stats.speed = p->curSpeed;
-                    stats.scrap = p->scrap; stats.kills = p->kills; stats.inventory.assign(std::begin(p->inventory), std::end(p->inventory));
-                    stats.isAdmin = p->isAdmin;
-
-                    Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-                    ser.value1b(GamePacket::STATS); ser.object(stats); ser.adapter().flush();
-                    SendToClient(id, DeliveryType::UNRELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
-                }
+                if (obj->type != EntityType::PLAYER || obj->destroyFlag) continue;
+                auto p = std::static_pointer_cast<Player>(obj);
+                uint16_t fields = fullStatsRefresh ? (uint16_t)StatsField::ALL : p->statsDirty;
+                if (fields == 0) continue;
+                p->statsDirty = 0;
+                SendPlayerStats(p, fields);
             }
-            statsTimer = 0;
         }
         std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 }
 
+void ServerHost::SendPlayerStats(const std::shared_ptr<Player>& p, uint16_t fields) {
+    PlayerStatsPacket stats;
+    stats.fields = fields;
+    stats.level = p->level; stats.currentXp = p->currentXp; stats.maxXp = p->maxXp;
+    stats.maxHealth = p->maxHealth; stats.damage = p->curDamage; stats.speed = p->curSpeed;
+    stats.scrap = p->scrap; stats.kills = p->kills;
+    if (fields & StatsField::INVENTORY) stats.inventory.assign(std::begin(p->inventory), std::end(p->inventory));
+    stats.isAdmin = p->isAdmin;
+
+    Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+    ser.value1b(GamePacket::STATS); ser.object(stats); ser.adapter().flush();
+    SendToClient(p->id, DeliveryType::RELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
+}
+
 void ServerHost::BroadcastToAll(DeliveryType type, StreamBuffer::Shared stream) {
     netServer->broadcast(type, stream);
-    if (!relayClientIds.empty() && masterClient && masterClient->isConnected()) {
-        for (uint32_t rid : relayClientIds) SendToClient(rid, type, stream);
+    if (!peers.RelayIds().empty() && masterClient && masterClient->isConnected()) {
+        SendRelayMulticast(peers.RelayIds(), type, stream);
+    }
+}
+
+void ServerHost::SendToClients(const std::vector<uint32_t>& peerIds, DeliveryType type, StreamBuffer::Shared stream) {
+    std::vector<uint32_t> relayIds;
+    for (uint32_t id : peerIds) {
+        if (peers.IsRelay(id)) relayIds.push_back(id);
+        else netServer->send(id, type, stream);
+    }
+    SendRelayMulticast(relayIds, type, stream);
+}
+
+// The master fans one RELAY_MULTICAST out to every target, so the payload crosses the
+// host uplink once. It can't use the per-session streams, so it is block-compressed.
+void ServerHost::SendRelayMulticast(const std::vector<uint32_t>& relayIds, DeliveryType type, StreamBuffer::Shared stream) {
+    if (relayIds.empty()) return;
+    if (relayIds.size() == 1) {
+        SendToClient(relayIds[0], type, stream);
+        return;
+    }
+    if (!masterClient || !masterClient->isConnected()) return;
+
+    RelayMulticastPacket mp;
+    mp.isReliable = (type == DeliveryType::RELIABLE);
+    const auto& rawData = stream->buffer();
+    std::vector<uint8_t> compressed;
+    if (rawData.size() > 128) compressed = CompressionHelper::Compress(rawData);
+    if (!compressed.empty() && compressed.size() < rawData.size()) {
+        mp.data = std::move(compressed);
+        mp.compression = RelayCompression::BLOCK;
+    }
+    else {
+        mp.data = rawData;
+    }
+
+    for (size_t first = 0; first < relayIds.size(); first += RelayMulticastPacket::MAX_TARGETS) {
+        size_t last = std::min(relayIds.size(), first + RelayMulticastPacket::MAX_TARGETS);
+        mp.targetIds.assign(relayIds.begin() + first, relayIds.begin() + last);
+
+        Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+        ser.value1b(GamePacket::RELAY_MULTICAST); ser.object(mp); ser.adapter().flush();
+        if (buf.size() > RELAY_MAX_PACKET_BYTES) {
+            std::cout << "[Relay] Dropped " << buf.size() << " byte multicast packet\n";
+            continue;
+        }
+        masterClient->send(type, StreamBuffer::alloc(buf.data(), buf.size()));
+    }
+}
+
+void ServerHost::ReportLinkStats() {
+    uint32_t rtt = 0; float loss = 0.0f;
+    for (uint32_t id : peers.Ids(PeerTable::Transport::DIRECT)) {
+        if (netServer->getPeerLinkStats(id, rtt, loss)) snapshotScheduler.ReportLink(id, rtt, loss);
+    }
+    // Relay clients are only visible through our own link to the master
+    if (!peers.RelayIds().empty() && masterClient && masterClient->getLinkStats(rtt, loss)) {
+        for (uint32_t rid : peers.RelayIds()) snapshotScheduler.ReportLink(rid, rtt, loss);
     }
 }
 
+// Sends a snapshot to every client whose rate and byte budget allow it this frame;
+// queued events ride along in those snapshots or go out as an EVENT_BATCH to the others.
 void ServerHost::BroadcastSnapshot() {
-    if (netServer->numClients() == 0 && relayClientIds.empty()) return;
+    if (peers.Size() == 0) {
+        gameScene.pendingEvents.clear();
+        return;
+    }
+
+    bool anyDue = snapshotScheduler.AnyDue();
+    if (!anyDue && gameScene.pendingEvents.empty()) return;
+
+    // Events beyond one batch stay queued for the next broadcast
+    EventBatchPacket events = EventBatchPacket::Encode(gameScene.pendingEvents);
+    gameScene.pendingEvents.erase(gameScene.pendingEvents.begin(), gameScene.pendingEvents.begin() + events.events.size());
+
+    StreamBuffer::Shared eventStream;
+    if (!events.events.empty()) {
+        Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+        ser.value1b(GamePacket::EVENT_BATCH); ser.object(events); ser.adapter().flush();
+        eventStream = StreamBuffer::alloc(buf.data(), buf.size());
+    }
+
+    if (!anyDue) {
+        BroadcastToAll(DeliveryType::UNRELIABLE, eventStream);
+        return;
+    }
 
-    WorldSnapshotPacket snap;
-    snap.serverTime = GetSystemTime();
-    snap.wave = waveCount;
+    std::vector<EntityState> world;
+    std::unordered_set<uint32_t> worldIds;
+    world.reserve(gameScene.objects.size() + gameScene.projectiles.Size());
+    worldIds.reserve(gameScene.objects.size() + gameScene.projectiles.Size());
     for (auto& [id, obj] : gameScene.objects) {
+        if (obj->destroyFlag) continue;
         EntityState state; state.id = obj->id;
         if (obj->body) { cpVect pos = cpBodyGetPosition(obj->body); state.position = ToRay(pos); state.rotation = obj->rotation; }
         else { state.position = { 0,0 }; state.rotation = 0; }
@@ -393,7 +537,6 @@ void ServerHost::BroadcastSnapshot() {
             auto p = std::dynamic_pointer_cast<Player>(obj);
             if (p) { state.level = p->level; state.kills = p->kills; state.name = p->name; }
         }
-        else if (obj->type == EntityType::BULLET) state.radius = 5.0f;
         else if (obj->type == EntityType::ENEMY) {
             auto e = std::dynamic_pointer_cast<Enemy>(obj); if (e) state.subtype = e->enemyType;
         }
@@ -401,10 +544,60 @@ void ServerHost::BroadcastSnapshot() {
             auto c = std::dynamic_pointer_cast<Construct>(obj); if (c) { state.ownerId = c->ownerId; state.level = c->level; }
             if (obj->type == EntityType::WALL) state.radius = 25.0f; else if (obj->type == EntityType::TURRET) state.radius = 20.0f; else state.radius = 15.0f;
         }
-        snap.entities.push_back(state);
+        world.push_back(state);
+        worldIds.insert(state.id);
+    }
+    const ProjectileSystem& projectiles = gameScene.projectiles;
+    for (size_t i = 0; i < projectiles.Size(); i++) {
+        EntityState state; state.id = projectiles.ids[i];
+        state.position = projectiles.positions[i];
+        state.rotation = atan2f(projectiles.velocities[i].y, projectiles.velocities[i].x) * RAD2DEG;
+        state.health = 100.0f; state.maxHealth = 100.0f; state.type = EntityType::BULLET; state.color = BLACK;
+        state.level = 1; state.kills = 0; state.radius = 5.0f; state.subtype = 0; state.ownerId = projectiles.owners[i];
+        world.push_back(state);
+        worldIds.insert(state.id);
+    }
+
+    bool attachEvents = snapshotScheduler.EventsFitSnapshot(events);
+    double now = GetSystemTime();
+    std::vector<uint32_t> eventTargets;
+    std::vector<uint32_t> fullSnapshotTargets;
+    StreamBuffer::Shared fullSnapshotStream;
+    std::vector<uint32_t> clientIds = peers.Ids(PeerTable::Transport::DIRECT);
+    clientIds.insert(clientIds.end(), peers.RelayIds().begin(), peers.RelayIds().end());
+    for (uint32_t clientId : clientIds) {
+        bool due = snapshotScheduler.IsDue(clientId);
+        if (eventStream && (!due || !attachEvents)) eventTargets.push_back(clientId);
+        if (!due) continue;
+
+        Vector2 viewerPos = { 0, 0 };
+        auto self = gameScene.objects.find(clientId);
+        if (self != gameScene.objects.end() && self->second->body) viewerPos = ToRay(cpBodyGetPosition(self->second->body));
+
+        WorldSnapshotPacket snap;
+        snap.serverTime = now;
+        snap.wave = waves.wave;
+        if (attachEvents) snap.events = events;
+        snapshotScheduler.BuildSnapshot(clientId, world, worldIds, viewerPos, now, snap);
+
+        // Full snapshots built this frame are byte-identical, so they share one stream and one multicast
+        if (!snap.isPartial) {
+            if (!fullSnapshotStream) {
+                Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+                ser.value1b(GamePacket::SNAPSHOT); ser.object(snap); ser.adapter().flush();
+                fullSnapshotStream = StreamBuffer::alloc(buf.data(), buf.size());
+            }
+            fullSnapshotTargets.push_back(clientId);
+            snapshotScheduler.OnSnapshotSent(clientId, fullSnapshotStream->buffer().size());
+            continue;
+        }
+
+        Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+        ser.value1b(GamePacket::SNAPSHOT); ser.object(snap); ser.adapter().flush();
+        SendToClient(clientId, DeliveryType::UNRELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
+        snapshotScheduler.OnSnapshotSent(clientId, buf.size());
     }
-    Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-    ser.value1b(GamePacket::SNAPSHOT); ser.object(snap); ser.adapter().flush();
 
-    BroadcastToAll(DeliveryType::UNRELIABLE, StreamBuffer::alloc(buf.data(), buf.size()));
+    if (eventStream) SendToClients(eventTargets, DeliveryType::UNRELIABLE, eventStream);
+    if (fullSnapshotStream) SendToClients(fullSnapshotTargets, DeliveryType::UNRELIABLE, fullSnapshotStream);
 }
\ No newline at end of file
@@ -6,26 +6,38 @@
 #include "enet/ENetServer.h"
 #include "enet/ENetClient.h"
 #include "Scenes/GameScene.h"
+#include "Utils/SnapshotScheduler.h"
+#include "Utils/WaveDirector.h"
+#include "PeerTable.h"
+#include "common/RelayStreamCompression.h"
 #include <thread>
 #include <atomic>
+#include <unordered_map>
+#include <memory>
 
 class ServerHost {
     ENetServer::Shared netServer;
     GameScene gameScene;
 
-    std::vector<uint32_t> relayClientIds;
+    PeerTable peers;
+    std::unordered_map<uint32_t, std::unique_ptr<RelayStreamEncoder>> relayEncoders;
+    SnapshotScheduler snapshotScheduler;
 
     ENetClient::Shared masterClient;
     double masterHeartbeatTimer = 0.0;
     bool connectedToMaster = false;
     bool useMasterServer = false;
+    // Retries the master connection after it drops, e.g. across a master restart
+    double masterReconnectTimer = 0.0;
+    const double MASTER_RECONNECT_DELAY = 3.0;
+    // Port of the current or pending master connection. Only the connect that follows a
+    // MASTER_REDIRECT uses a shard port; retries always go through the configured entry port.
+    int masterPort = 0;
 
     std::atomic<bool> running{ false };
     std::thread serverThread;
 
-    double waveTimer = 0.0;
-    double timeToNextWave = 5.0;
-    int waveCount = 1;
+    WaveDirector waves;
 
 public:
     ServerHost();
@@ -39,9 +51,15 @@ public:
     ENetServer::Shared getNetServer() { return netServer; }
 
 private:
-    void RegisterWithMaster();
+    void RegisterWithMaster(int port);
+    void SendMasterRegister();
+    void UpdateMasterReconnect(double dt);
     void UpdateMasterHeartbeat(float dt);
     void ProcessGamePacket(uint32_t peerId, StreamBuffer::Shared stream);
     void BroadcastToAll(DeliveryType type, StreamBuffer::Shared stream);
     void SendToClient(uint32_t peerId, DeliveryType type, StreamBuffer::Shared stream);
+    void SendToClients(const std::vector<uint32_t>& peerIds, DeliveryType type, StreamBuffer::Shared stream);
+    void SendRelayMulticast(const std::vector<uint32_t>& relayIds, DeliveryType type, StreamBuffer::Shared stream);
+    void SendPlayerStats(const std::shared_ptr<Player>& p, uint16_t fields);
+    void ReportLinkStats();
 };
\ No newline at end of file
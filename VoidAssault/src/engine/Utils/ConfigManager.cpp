@@ -3,7 +3,9 @@
 
 GameConfig ConfigManager::config;
 std::string ConfigManager::configPath;
+#ifndef VOID_HEADLESS
 Font ConfigManager::mainFont = { 0 };
+#endif
 std::map<std::string, std::string> ConfigManager::localizedStrings;
 
 void ConfigManager::Initialize(const std::string& savePath) {
@@ -13,8 +15,10 @@ void ConfigManager::Initialize(const std::string& savePath) {
 	}
 	configPath = savePath + "config.json";
 	Load();
+#ifndef VOID_HEADLESS
 	LoadFonts();
 	LoadLanguage(config.client.language);
+#endif
 }
 
 void ConfigManager::CreateDefaultConfig() {
@@ -54,7 +58,23 @@ void ConfigManager::Save() {
 		{"pvpDamageFactor", config.server.pvpDamageFactor},
 		{"maxPlayers", config.server.maxPlayers},
 		{"tickRate", config.server.tickRate},
-		{"serverName", config.server.serverName}
+		{"serverName", config.server.serverName},
+		{"snapshotRate", config.server.snapshotRate},
+		{"minSnapshotRate", config.server.minSnapshotRate},
+		{"clientBytesPerSecond", config.server.clientBytesPerSecond},
+		{"snapshotMtu", config.server.snapshotMtu},
+		{"simulationThreads", config.server.simulationThreads},
+		{"deterministicSimulation", config.server.deterministicSimulation},
+		{"physicsIterations", config.server.physicsIterations},
+		{"physicsThreads", config.server.physicsThreads},
+		{"physicsSpatialHash", config.server.physicsSpatialHash},
+		{"physicsHashCellSize", config.server.physicsHashCellSize},
+		{"dormancyRadius", config.server.dormancyRadius},
+		{"dormantTickInterval", config.server.dormantTickInterval},
+		{"waveSpawnsPerTick", config.server.waveSpawnsPerTick},
+		{"minEnemyCap", config.server.minEnemyCap},
+		{"maxEnemyCap", config.server.maxEnemyCap},
+		{"profileInterval", config.server.profileInterval}
 	};
 
 	std::ofstream file(configPath);
@@ -95,12 +115,29 @@ void ConfigManager::Load() {
 				config.server.maxPlayers = j["server"].value("maxPlayers", 8);
 				config.server.tickRate = j["server"].value("tickRate", 60);
 				config.server.serverName = j["server"].value("serverName", "Void Server");
+				config.server.snapshotRate = j["server"].value("snapshotRate", 30);
+				config.server.minSnapshotRate = j["server"].value("minSnapshotRate", 8);
+				config.server.clientBytesPerSecond = j["server"].value("clientBytesPerSecond", 96000);
+				config.server.snapshotMtu = j["server"].value("snapshotMtu", 1200);
+				config.server.simulationThreads = j["server"].value("simulationThreads", 2);
+				config.server.deterministicSimulation = j["server"].value("deterministicSimulation", true);
+				config.server.physicsIterations = j["server"].value("physicsIterations", 10);
+				config.server.physicsThreads = j["server"].value("physicsThreads", 1);
+				config.server.physicsSpatialHash = j["server"].value("physicsSpatialHash", true);
+				config.server.physicsHashCellSize = j["server"].value("physicsHashCellSize", 50.0f);
+				config.server.dormancyRadius = j["server"].value("dormancyRadius", 1500.0f);
+				config.server.dormantTickInterval = j["server"].value("dormantTickInterval", 4);
+				config.server.waveSpawnsPerTick = j["server"].value("waveSpawnsPerTick", 4);
+				config.server.minEnemyCap = j["server"].value("minEnemyCap", 60);
+				config.server.maxEnemyCap = j["server"].value("maxEnemyCap", 400);
+				config.server.profileInterval = j["server"].value("profileInterval", 0);
 			}
 		}
 		catch (...) { CreateDefaultConfig(); }
 	}
 }
 
+#ifndef VOID_HEADLESS
 void ConfigManager::LoadFonts() {
 	int codepoints[512] = { 0 };
 	for (int i = 0; i < 95; i++) codepoints[i] = 32 + i;
@@ -115,9 +152,11 @@ void ConfigManager::LoadFonts() {
 }
 
 void ConfigManager::UnloadResources() { if (mainFont.texture.id != 0) UnloadFont(mainFont); }
+#endif
 
 void ConfigManager::LoadLanguage(const std::string& langCode) {
 	localizedStrings.clear();
+#ifndef VOID_HEADLESS
 	std::string path = "assets/lang/lang_" + langCode + ".json";
 	char* text = LoadFileText(path.c_str());
 	if (text) {
@@ -128,6 +167,7 @@ void ConfigManager::LoadLanguage(const std::string& langCode) {
 		catch (...) {}
 		UnloadFileText(text);
 	}
+#endif
 }
 
 const char* ConfigManager::Text(const std::string& key) {
@@ -155,5 +195,7 @@ void ConfigManager::CycleLanguage()
 
 ClientConfig& ConfigManager::GetClient() { return config.client; }
 ServerConfig& ConfigManager::GetServer() { return config.server; }
+#ifndef VOID_HEADLESS
 Font ConfigManager::GetFont() { return mainFont; }
-void ConfigManager::SetFont(Font font) { mainFont = font; }
\ No newline at end of file
+void ConfigManager::SetFont(Font font) { mainFont = font; }
+#endif
\ No newline at end of file
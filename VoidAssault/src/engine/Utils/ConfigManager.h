@@ -5,7 +5,7 @@
 #include <iostream>
 #include <map>
 #include <vector>
-#include "raylib.h"
+#include "../raylib_compatibility.h"
 #include "nlohmann/json.hpp"
 using json = nlohmann::json;
 #include "MasterServerIP.h"
@@ -44,6 +44,34 @@ struct ServerConfig {
 	int tickRate = 60;
 	float pvpDamageFactor = 1.0f;
 	std::string serverName = "Void Lobby";
+
+	int snapshotRate = 30;
+	int minSnapshotRate = 8;
+	int clientBytesPerSecond = 96000;
+	// Snapshots are kept below this size so they are never fragmented
+	int snapshotMtu = 1200;
+
+	// Worker threads for the parallel AI update, counting the server thread; 0 uses every core
+	int simulationThreads = 2;
+	// Fixed job partitioning, so results are identical for any simulationThreads
+	bool deterministicSimulation = true;
+
+	int physicsIterations = 10;
+	// More than 1 runs the Chipmunk solver on that many threads (not on Windows)
+	int physicsThreads = 1;
+	bool physicsSpatialHash = true;
+	float physicsHashCellSize = 50.0f;
+	// Enemies and artifacts farther than this from every player are simulated at a reduced rate
+	float dormancyRadius = 1500.0f;
+	// Dormant entities update once every this many ticks
+	int dormantTickInterval = 4;
+	// Enemies released from a wave's spawn plan per tick
+	int waveSpawnsPerTick = 4;
+	// Bounds of the live enemy cap, which otherwise follows the measured tick time
+	int minEnemyCap = 60;
+	int maxEnemyCap = 400;
+	// Seconds between tick profile lines in the server log; 0 disables them
+	int profileInterval = 0;
 };
 
 struct GameConfig {
@@ -55,7 +83,9 @@ class ConfigManager {
 private:
 	static GameConfig config;
 	static std::string configPath;
+#ifndef VOID_HEADLESS
 	static Font mainFont;
+#endif
 	static std::map<std::string, std::string> localizedStrings;
 	static void CreateDefaultConfig();
 public:
@@ -70,8 +100,10 @@ public:
 	static ClientConfig& GetClient();
 	static ServerConfig& GetServer();
 
+#ifndef VOID_HEADLESS
 	static void LoadFonts();
 	static Font GetFont();
 	static void SetFont(Font font);
 	static void UnloadResources();
+#endif
 };
\ No newline at end of file
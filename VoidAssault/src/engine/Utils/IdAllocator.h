@@ -0,0 +1,32 @@
+﻿#pragma once
+#include <deque>
+#include <utility>
+#include <cstdint>
+
+// Entity ids for everything except players (which use their peer id). Released ids are
+// handed out again once they have been unused for QUARANTINE seconds of simulation time,
+// long enough for every client to have seen the old entity disappear.
+class IdAllocator {
+public:
+    static constexpr double QUARANTINE = 5.0;
+
+    explicit IdAllocator(uint32_t firstId = 1000) : next(firstId) {}
+
+    uint32_t Allocate(double now) {
+        if (!released.empty() && now - released.front().second >= QUARANTINE) {
+            uint32_t id = released.front().first;
+            released.pop_front();
+            return id;
+        }
+        return next++;
+    }
+
+    void Release(uint32_t id, double now) { released.push_back({ id, now }); }
+
+    size_t NumReleased() const { return released.size(); }
+
+private:
+    uint32_t next;
+    // Oldest first, so the front is always the first id to come out of quarantine
+    std::deque<std::pair<uint32_t, double>> released;
+};
@@ -0,0 +1,142 @@
+﻿#pragma once
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <atomic>
+#include <algorithm>
+#include <cstddef>
+
+// Fixed pool of worker threads for data-parallel loops over the simulation.
+// ParallelFor splits [0, count) into chunks that workers and the calling thread claim
+// until none are left, and returns once every chunk has run. Jobs must only read shared
+// state and write to their own slots; anything else belongs in a serial apply step.
+// In deterministic mode chunks have a fixed size, so the partitioning (and any per-chunk
+// output) is the same for every thread count.
+class JobSystem {
+public:
+    typedef std::function<void(size_t begin, size_t end)> RangeJob;
+
+    // Chunk size used in deterministic mode, and the smallest chunk otherwise
+    static constexpr size_t CHUNK_SIZE = 64;
+
+    JobSystem() = default;
+    ~JobSystem() { Shutdown(); }
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    // threads counts the calling thread; 0 uses every hardware thread
+    void Start(int threads, bool deterministicMode) {
+        Shutdown();
+        deterministic = deterministicMode;
+        int total = (threads > 0) ? threads : (int)std::max(1u, std::thread::hardware_concurrency());
+        stopping = false;
+        for (int i = 1; i < total; i++) workers.emplace_back([this]() { WorkerLoop(); });
+    }
+
+    void Shutdown() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : workers) t.join();
+        workers.clear();
+    }
+
+    size_t NumThreads() const { return workers.size() + 1; }
+    bool IsDeterministic() const { return deterministic; }
+
+    void ParallelFor(size_t count, const RangeJob& job) {
+        if (count == 0) return;
+        size_t chunk = ChunkSizeFor(count);
+        size_t chunks = (count + chunk - 1) / chunk;
+        if (workers.empty() || chunks == 1) {
+            for (size_t begin = 0; begin < count; begin += chunk) job(begin, std::min(count, begin + chunk));
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            current = &job;
+            total = count;
+            chunkSize = chunk;
+            numChunks = chunks;
+            nextChunk = 0;
+            doneChunks = 0;
+            generation++;
+        }
+        wake.notify_all();
+
+        RunChunks(job, count, chunk, chunks);
+
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [&]() { return doneChunks == numChunks && activeWorkers == 0; });
+        current = nullptr;
+    }
+
+private:
+    size_t ChunkSizeFor(size_t count) const {
+        if (deterministic) return CHUNK_SIZE;
+        // A few chunks per thread keeps the load balanced without much claiming overhead
+        size_t perThread = (count + NumThreads() * 4 - 1) / (NumThreads() * 4);
+        return std::max(CHUNK_SIZE, perThread);
+    }
+
+    void RunChunks(const RangeJob& job, size_t count, size_t chunk, size_t chunks) {
+        size_t done = 0;
+        for (size_t c = nextChunk.fetch_add(1); c < chunks; c = nextChunk.fetch_add(1)) {
+            size_t begin = c * chunk;
+            job(begin, std::min(count, begin + chunk));
+            done++;
+        }
+        if (done == 0) return;
+        std::lock_guard<std::mutex> lock(mutex);
+        doneChunks += done;
+        if (doneChunks == numChunks) finished.notify_all();
+    }
+
+    void WorkerLoop() {
+        uint64_t seen = 0;
+        while (true) {
+            const RangeJob* job;
+            size_t count, chunk, chunks;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&]() { return stopping || (current && generation != seen); });
+                if (stopping) return;
+                seen = generation;
+                job = current;
+                count = total;
+                chunk = chunkSize;
+                chunks = numChunks;
+                activeWorkers++;
+            }
+            RunChunks(*job, count, chunk, chunks);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                activeWorkers--;
+            }
+            finished.notify_all();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    bool deterministic = true;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable finished;
+    bool stopping = false;
+    uint64_t generation = 0;
+    int activeWorkers = 0;
+
+    const RangeJob* current = nullptr;
+    size_t total = 0;
+    size_t chunkSize = CHUNK_SIZE;
+    size_t numChunks = 0;
+    size_t doneChunks = 0;
+    std::atomic<size_t> nextChunk{ 0 };
+};
@@ -0,0 +1,23 @@
+﻿#pragma once
+#include <cstdint>
+
+// Simulation time owned by the GameScene: a tick counter times the fixed step. It only
+// advances when the simulation does, so timing rules behave the same whether the world
+// runs in real time, faster for benchmarks, or is replayed.
+class SimClock {
+public:
+    void SetTickRate(int ticksPerSecond) {
+        step = 1.0 / (double)(ticksPerSecond > 0 ? ticksPerSecond : 60);
+    }
+
+    void Advance() { tick++; }
+    void Reset() { tick = 0; }
+
+    uint64_t Tick() const { return tick; }
+    double Step() const { return step; }
+    double Now() const { return (double)tick * step; }
+
+private:
+    uint64_t tick = 0;
+    double step = 1.0 / 60.0;
+};
@@ -0,0 +1,226 @@
+﻿#pragma once
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include "raylib_compatibility.h"
+#include "../../common/NetworkPackets.h"
+
+// Per-client snapshot pacing. Each client gets its own snapshot rate, adapted from the
+// measured RTT/packet loss of its link, and a byte budget refilled at clientBytesPerSecond.
+// Every snapshot is kept under snapshotMtu so ENet never fragments it: when the world does
+// not fit, entities are picked by a per-client priority accumulator that grows with type
+// relevance and proximity while an entity waits, and is reset once it has been sent.
+class SnapshotScheduler {
+public:
+    struct ClientState {
+        uint32_t id = 0;
+        float snapshotRate = 30.0f;
+        double snapshotTimer = 0.0;
+        double budgetBytes = 0.0;
+        uint32_t roundTripTimeMs = 0;
+        float packetLoss = 0.0f;
+        double lastBuildTime = -1.0;
+        // Entities this client has been sent, with the time of their last update
+        std::unordered_map<uint32_t, double> lastSentTime;
+        // Priority accrued by each entity since it was last sent
+        std::unordered_map<uint32_t, float> priority;
+        // Despawned entities still to be reported in partial snapshots, with expiry time
+        std::unordered_map<uint32_t, double> pendingRemovals;
+    };
+
+    float maxRate = 30.0f;
+    float minRate = 8.0f;
+    double bytesPerSecond = 96000.0;
+    size_t mtuBytes = 1200;
+
+    // Pending removals are repeated for this long so a lost snapshot doesn't leave ghosts
+    const double REMOVAL_RESEND_TIME = 1.0;
+    // Approximate bitsery size of the fixed part of a WorldSnapshotPacket
+    const size_t SNAPSHOT_HEADER_BYTES = 32;
+    // Approximate bitsery size of an EntityState without its name
+    static constexpr size_t ENTITY_BYTES = 47;
+
+    void Configure(int snapshotRate, int minSnapshotRate, int clientBytesPerSecond, int snapshotMtu) {
+        snapshotRate = std::max(1, snapshotRate);
+        maxRate = (float)snapshotRate;
+        minRate = (float)std::clamp(minSnapshotRate, 1, snapshotRate);
+        bytesPerSecond = (double)std::max(1024, clientBytesPerSecond);
+        mtuBytes = (size_t)std::max(256, snapshotMtu);
+    }
+
+    void AddClient(uint32_t id) {
+        ClientState& c = clients[id];
+        c = ClientState();
+        c.id = id;
+        c.snapshotRate = maxRate;
+        c.budgetBytes = BurstBytes();
+    }
+
+    void RemoveClient(uint32_t id) { clients.erase(id); }
+    bool HasClient(uint32_t id) const { return clients.count(id) > 0; }
+    size_t NumClients() const { return clients.size(); }
+    const std::unordered_map<uint32_t, ClientState>& Clients() const { return clients; }
+
+    void Clear() { clients.clear(); }
+
+    void Advance(double dt) {
+        for (auto& [id, c] : clients) {
+            c.snapshotTimer += dt;
+            c.budgetBytes = std::min(c.budgetBytes + bytesPerSecond * dt, BurstBytes());
+        }
+    }
+
+    // Multiplicative decrease on a bad link, additive recovery on a good one
+    void ReportLink(uint32_t id, uint32_t roundTripTimeMs, float packetLoss) {
+        auto it = clients.find(id);
+        if (it == clients.end()) return;
+        ClientState& c = it->second;
+        c.roundTripTimeMs = roundTripTimeMs;
+        c.packetLoss = packetLoss;
+
+        if (packetLoss > 0.10f || roundTripTimeMs > 400) c.snapshotRate *= 0.75f;
+        else if (packetLoss < 0.02f && roundTripTimeMs < 200) c.snapshotRate += 2.0f;
+        c.snapshotRate = std::clamp(c.snapshotRate, minRate, maxRate);
+    }
+
+    bool IsDue(uint32_t id) const {
+        auto it = clients.find(id);
+        return it != clients.end() && IsDue(it->second);
+    }
+
+    bool AnyDue() const {
+        for (const auto& [id, c] : clients) if (IsDue(c)) return true;
+        return false;
+    }
+
+    static size_t EstimateEntityBytes(const EntityState& e) {
+        return ENTITY_BYTES + e.name.size();
+    }
+
+    static size_t EstimateEventBytes(const EventBatchPacket& events) {
+        return 2 + events.events.size() * sizeof(BatchedEvent);
+    }
+
+    // Events that would take too much of the datagram are sent as their own EVENT_BATCH
+    bool EventsFitSnapshot(const EventBatchPacket& events) const {
+        return EstimateEventBytes(events) <= mtuBytes / 2;
+    }
+
+    // Fills snap.entities/isPartial/removedIds for one client from the full world state.
+    // snap.events must already be set, it counts against the datagram size.
+    // viewerPos is the client's player position, used to weight entity priority.
+    void BuildSnapshot(uint32_t id, const std::vector<EntityState>& world, const std::unordered_set<uint32_t>& worldIds,
+        Vector2 viewerPos, double now, WorldSnapshotPacket& snap) {
+        ClientState& c = clients[id];
+        float elapsed = (c.lastBuildTime < 0.0) ? 1.0f : (float)std::min(now - c.lastBuildTime, 1.0);
+        c.lastBuildTime = now;
+
+        for (auto it = c.lastSentTime.begin(); it != c.lastSentTime.end();) {
+            if (!worldIds.count(it->first)) {
+                c.pendingRemovals[it->first] = now + REMOVAL_RESEND_TIME;
+                it = c.lastSentTime.erase(it);
+            }
+            else ++it;
+        }
+        for (auto it = c.pendingRemovals.begin(); it != c.pendingRemovals.end();) {
+            if (it->second < now) it = c.pendingRemovals.erase(it);
+            else ++it;
+        }
+        for (auto it = c.priority.begin(); it != c.priority.end();) {
+            if (!worldIds.count(it->first)) it = c.priority.erase(it);
+            else ++it;
+        }
+
+        size_t limit = std::min(mtuBytes, (size_t)std::max(0.0, c.budgetBytes));
+        size_t baseBytes = SNAPSHOT_HEADER_BYTES + EstimateEventBytes(snap.events);
+
+        size_t fullBytes = baseBytes;
+        for (const auto& e : world) fullBytes += EstimateEntityBytes(e);
+
+        if (fullBytes <= limit) {
+            snap.entities = world;
+            snap.isPartial = false;
+            snap.removedIds.clear();
+            c.pendingRemovals.clear();
+            for (const auto& e : world) c.lastSentTime[e.id] = now;
+            c.priority.clear();
+            return;
+        }
+
+        size_t used = baseBytes;
+        snap.removedIds.clear();
+        for (const auto& [rid, expiry] : c.pendingRemovals) {
+            if (used + 4 > limit / 2) break;
+            snap.removedIds.push_back(rid);
+            used += 4;
+        }
+
+        snap.entities.clear();
+        std::vector<std::pair<float, size_t>> ranked;
+        ranked.reserve(world.size());
+        for (size_t i = 0; i < world.size(); i++) {
+            const EntityState& e = world[i];
+            // The client's own player always goes first, whatever the budget
+            if (e.id == id) {
+                snap.entities.push_back(e);
+                used += EstimateEntityBytes(e);
+                c.lastSentTime[e.id] = now;
+                continue;
+            }
+            float& acc = c.priority[e.id];
+            float dist = Vector2Distance(viewerPos, e.position);
+            float rate = TypeRelevance(e) / (1.0f + dist / 500.0f);
+            // Entities the client has never seen get a head start so they appear quickly
+            if (!c.lastSentTime.count(e.id)) rate *= 4.0f;
+            acc += rate * elapsed;
+            ranked.push_back({ acc, i });
+        }
+        std::sort(ranked.begin(), ranked.end(), [](const auto& a, const auto& b) { return a.first > b.first; });
+
+        for (const auto& [score, index] : ranked) {
+            // Keep scanning for smaller entries only while there is room for one
+            if (used >= limit || limit - used < ENTITY_BYTES) break;
+            const EntityState& e = world[index];
+            size_t bytes = EstimateEntityBytes(e);
+            if (used + bytes > limit) continue;
+            used += bytes;
+            snap.entities.push_back(e);
+            c.lastSentTime[e.id] = now;
+            c.priority[e.id] = 0.0f;
+        }
+        snap.isPartial = true;
+    }
+
+    void OnSnapshotSent(uint32_t id, size_t bytes) {
+        auto it = clients.find(id);
+        if (it == clients.end()) return;
+        it->second.snapshotTimer = 0.0;
+        it->second.budgetBytes -= (double)bytes;
+    }
+
+private:
+    std::unordered_map<uint32_t, ClientState> clients;
+
+    // Below this the snapshot is postponed until the budget refills
+    const double MIN_SNAPSHOT_BYTES = 256.0;
+
+    // Enough budget for a quarter second of traffic, so one snapshot can always be sent
+    double BurstBytes() const { return bytesPerSecond * 0.25; }
+
+    bool IsDue(const ClientState& c) const {
+        return c.snapshotTimer >= 1.0 / c.snapshotRate && c.budgetBytes >= MIN_SNAPSHOT_BYTES;
+    }
+
+    // Priority gained per second: player > boss > enemy > bullet > static construct
+    static float TypeRelevance(const EntityState& e) {
+        switch (e.type) {
+        case EntityType::PLAYER: return 10.0f;
+        case EntityType::ENEMY: return (e.subtype == EnemyType::BOSS) ? 8.0f : 5.0f;
+        case EntityType::BULLET: return 3.0f;
+        case EntityType::ARTIFACT: return 2.0f;
+        default: return 1.0f;
+        }
+    }
+};
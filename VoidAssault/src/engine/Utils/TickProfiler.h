@@ -0,0 +1,91 @@
+﻿#pragma once
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <algorithm>
+
+// Averages and peaks of where server tick time goes, reported periodically so load at
+// a given wave can be compared between configurations
+class TickProfiler {
+public:
+    enum Section {
+        PHYSICS,
+        AI,
+        COLLISIONS,
+        NETWORK,
+        SECTION_COUNT
+    };
+
+    class Scope {
+    public:
+        Scope(TickProfiler& profiler, Section section)
+            : profiler(profiler), section(section), start(std::chrono::steady_clock::now()) {}
+        ~Scope() {
+            profiler.Add(section, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+    private:
+        TickProfiler& profiler;
+        Section section;
+        std::chrono::steady_clock::time_point start;
+    };
+
+    void Add(Section section, double seconds) {
+        sections[section].total += seconds;
+        sections[section].peak = std::max(sections[section].peak, seconds);
+    }
+
+    void AddTick(double seconds, size_t entities) {
+        tick.total += seconds;
+        tick.peak = std::max(tick.peak, seconds);
+        ticks++;
+        entityTotal += entities;
+        lastTickSeconds = seconds;
+    }
+
+    void AddActivity(size_t dormant, size_t total) {
+        dormantTotal += dormant;
+        activityTotal += total;
+    }
+
+    size_t Ticks() const { return ticks; }
+    double AverageTickMs() const { return ticks ? tick.total * 1000.0 / ticks : 0.0; }
+    double LastTickMs() const { return lastTickSeconds * 1000.0; }
+
+    std::string Report(int wave) const {
+        if (ticks == 0) return "";
+        auto avg = [&](const Sample& s) { return s.total * 1000.0 / ticks; };
+        double dormantPct = activityTotal ? 100.0 * (double)dormantTotal / (double)activityTotal : 0.0;
+        char buf[352];
+        std::snprintf(buf, sizeof(buf),
+            "wave %d, %zu entities (%.0f%% dormant): tick %.3f ms (peak %.3f) | physics %.3f (%.3f) | ai %.3f (%.3f) | collisions %.3f (%.3f) | network %.3f (%.3f)",
+            wave, entityTotal / ticks, dormantPct, avg(tick), tick.peak * 1000.0,
+            avg(sections[PHYSICS]), sections[PHYSICS].peak * 1000.0,
+            avg(sections[AI]), sections[AI].peak * 1000.0,
+            avg(sections[COLLISIONS]), sections[COLLISIONS].peak * 1000.0,
+            avg(sections[NETWORK]), sections[NETWORK].peak * 1000.0);
+        return buf;
+    }
+
+    void Reset() {
+        for (auto& s : sections) s = Sample();
+        tick = Sample();
+        ticks = 0;
+        entityTotal = 0;
+        dormantTotal = 0;
+        activityTotal = 0;
+    }
+
+private:
+    struct Sample {
+        double total = 0.0;
+        double peak = 0.0;
+    };
+
+    Sample sections[SECTION_COUNT];
+    Sample tick;
+    size_t ticks = 0;
+    size_t entityTotal = 0;
+    size_t dormantTotal = 0;
+    size_t activityTotal = 0;
+    double lastTickSeconds = 0.0;
+};
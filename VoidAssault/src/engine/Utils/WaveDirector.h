@@ -0,0 +1,98 @@
+﻿#pragma once
+#include <deque>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include "../ECS/Enemy.h"
+
+// Starts waves and decides what they contain. A wave's enemies are rolled up front into a
+// spawn plan that is released a few per tick instead of all in one tick, and the number of
+// live enemies is capped by how much of the tick interval the simulation leaves unused.
+class WaveDirector {
+public:
+    int wave = 1;
+    double waveTimer = 0.0;
+    double timeToNextWave = 5.0;
+
+    // Share of the tick interval the simulation may take; the cap shrinks above it
+    const double TARGET_TICK_LOAD = 0.5;
+    // Enemy cap until the tick time has been measured
+    const int DEFAULT_ENEMY_CAP = 120;
+
+    void Configure(int tickRate, int spawnsPerTick, int minEnemyCap, int maxEnemyCap) {
+        tickBudgetMs = 1000.0 / (double)std::max(1, tickRate);
+        maxSpawnsPerTick = std::max(1, spawnsPerTick);
+        minCap = std::max(1, minEnemyCap);
+        maxCap = std::max(minCap, maxEnemyCap);
+        enemyCap = std::clamp(DEFAULT_ENEMY_CAP, minCap, maxCap);
+    }
+
+    void Reset() {
+        wave = 1;
+        waveTimer = 0.0;
+        timeToNextWave = 5.0;
+        plan.clear();
+    }
+
+    // Starts the next wave once its timer runs out, if there is room under the cap.
+    // Returns true when a wave was planned.
+    bool Advance(double dt, bool hasPlayers, int aliveEnemies) {
+        waveTimer += dt;
+        if (waveTimer < timeToNextWave || !hasPlayers) return false;
+        waveTimer = 0.0;
+        timeToNextWave = 20.0 + (wave * 2.0);
+        if (aliveEnemies + (int)plan.size() >= enemyCap) return false;
+
+        int count = std::min(5 + (wave * 2), 60);
+        for (int i = 0; i < count; i++) plan.push_back(Enemy::RandomType());
+        if (wave % 5 == 0) plan.push_back(EnemyType::BOSS);
+        wave++;
+        return true;
+    }
+
+    // Fed every tick with its duration and the entity count it simulated
+    void ReportTick(double tickMs, size_t entities) {
+        const double SMOOTHING = 0.05;
+        if (!measured) { smoothedTickMs = tickMs; smoothedEntities = (double)entities; measured = true; }
+        else {
+            smoothedTickMs += (tickMs - smoothedTickMs) * SMOOTHING;
+            smoothedEntities += ((double)entities - smoothedEntities) * SMOOTHING;
+        }
+        lastTickMs = tickMs;
+
+        // Entities the target load allows at the measured average cost per entity
+        double msPerEntity = smoothedTickMs / std::max(1.0, smoothedEntities);
+        if (msPerEntity <= 0.0) { enemyCap = maxCap; return; }
+        double allowed = TARGET_TICK_LOAD * tickBudgetMs / msPerEntity;
+        enemyCap = (int)std::clamp(allowed, (double)minCap, (double)maxCap);
+    }
+
+    int EnemyCap() const { return enemyCap; }
+    size_t PendingSpawns() const { return plan.size(); }
+
+    // Planned enemies to spawn this tick; only one while the last tick ran over the target load
+    int SpawnBudget(int aliveEnemies) const {
+        if (plan.empty()) return 0;
+        int budget = (lastTickMs > TARGET_TICK_LOAD * tickBudgetMs) ? 1 : maxSpawnsPerTick;
+        return std::max(0, std::min({ budget, enemyCap - aliveEnemies, (int)plan.size() }));
+    }
+
+    uint8_t NextSpawn() {
+        uint8_t type = plan.front();
+        plan.pop_front();
+        return type;
+    }
+
+private:
+    std::deque<uint8_t> plan;
+    double tickBudgetMs = 1000.0 / 60.0;
+    int maxSpawnsPerTick = 4;
+    int minCap = 60;
+    int maxCap = 400;
+    int enemyCap = 120;
+
+    bool measured = false;
+    double smoothedTickMs = 0.0;
+    double smoothedEntities = 0.0;
+    double lastTickMs = 0.0;
+};
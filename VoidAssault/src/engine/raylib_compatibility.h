@@ -5,4 +5,4 @@
 #include "fix_win32_compatibility.h"
 #endif
 
-#include "raylib.h"
\ No newline at end of file
+#include "RaylibTypes.h"
\ No newline at end of file
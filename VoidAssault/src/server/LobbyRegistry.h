@@ -0,0 +1,380 @@
+﻿#pragma once
+#include "../common/NetworkPackets.h"
+#include <unordered_map>
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <shared_mutex>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <fstream>
+#include <iterator>
+#include <filesystem>
+
+struct ActiveLobby {
+    uint32_t id;
+    std::string ip;
+    uint16_t port;
+    std::string name;
+    uint8_t currentPlayers;
+    uint8_t maxPlayers;
+    uint8_t wave;
+    double lastHeartbeatTime;
+    uint32_t peerId;
+    // Shard the host is connected to; peer ids are only unique within a shard
+    int shard;
+    uint16_t relayPort;
+    // Restored from a snapshot and not yet claimed by its host: listed, but has no peer to reach
+    bool provisional = false;
+};
+
+// On-disk copy of the registry, written by LobbyRegistry::SaveSnapshot
+struct LobbySnapshotFile {
+    static const uint32_t MAGIC = 0x4C4F4256; // "VBOL"
+    static const uint16_t FORMAT = 1;
+
+    uint32_t magic = MAGIC;
+    uint16_t format = FORMAT;
+    // Wall clock seconds; the registry clock doesn't survive a restart
+    uint64_t savedAt = 0;
+    uint32_t nextLobbyId = 1;
+    uint32_t version = 1;
+    std::vector<LobbyInfo> lobbies;
+
+    template <typename S>
+    void serialize(S& s) {
+        s.value4b(magic);
+        s.value2b(format);
+        s.value8b(savedAt);
+        s.value4b(nextLobbyId);
+        s.value4b(version);
+        s.container(lobbies, 65535);
+    }
+};
+
+// Immutable lobby list for one registry version, with the unfiltered pages already
+// serialized so most list requests are answered without touching the registry.
+struct LobbyListCache {
+    static const uint8_t PAGE_SIZE = 50;
+
+    uint32_t version = 0;
+    double buildTime = 0.0;
+    std::vector<LobbyInfo> lobbies;
+    std::vector<StreamBuffer::Shared> pages;
+
+    static StreamBuffer::Shared Encode(const MasterListResPacket& res) {
+        Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+        ser.value1b(GamePacket::MASTER_LIST_RES); ser.object(res); ser.adapter().flush();
+        return StreamBuffer::alloc(buf.data(), buf.size());
+    }
+
+    static StreamBuffer::Shared EncodePage(uint32_t version, const std::vector<const LobbyInfo*>& matches, uint16_t page, uint8_t pageSize) {
+        MasterListResPacket res;
+        res.version = version;
+        res.totalLobbies = (uint32_t)matches.size();
+        res.totalPages = (uint16_t)std::max<size_t>(1, (matches.size() + pageSize - 1) / pageSize);
+        res.page = page;
+        size_t first = (size_t)page * pageSize;
+        for (size_t i = first; i < matches.size() && i < first + pageSize; i++) res.lobbies.push_back(*matches[i]);
+        return Encode(res);
+    }
+
+    void BuildPages() {
+        std::vector<const LobbyInfo*> all;
+        all.reserve(lobbies.size());
+        for (const auto& l : lobbies) all.push_back(&l);
+        size_t count = std::max<size_t>(1, (all.size() + PAGE_SIZE - 1) / PAGE_SIZE);
+        pages.clear();
+        for (size_t page = 0; page < count; page++) pages.push_back(EncodePage(version, all, (uint16_t)page, PAGE_SIZE));
+    }
+
+    StreamBuffer::Shared Query(const MasterListReqPacket& req) const {
+        if (req.knownVersion == version) {
+            MasterListResPacket res;
+            res.version = version;
+            res.notModified = true;
+            return Encode(res);
+        }
+        if (!req.HasFilters() && req.pageSize == PAGE_SIZE && req.page < pages.size()) return pages[req.page];
+
+        std::vector<const LobbyInfo*> matches;
+        for (const auto& l : lobbies) {
+            if (req.notFull && l.currentPlayers >= l.maxPlayers) continue;
+            if (l.wave < req.minWave || l.wave > req.maxWave) continue;
+            if (!req.namePrefix.empty() && l.name.compare(0, req.namePrefix.size(), req.namePrefix) != 0) continue;
+            matches.push_back(&l);
+        }
+        uint8_t pageSize = std::max<uint8_t>(1, req.pageSize);
+        return EncodePage(version, matches, req.page, pageSize);
+    }
+};
+
+// Lobby table shared by all master shards. Relay and list traffic only read it,
+// so readers take a shared lock and only registration/heartbeat/expiry write.
+// Lobbies are indexed by id and by host (shard, peer), and heartbeat expiry runs off a
+// timing wheel with one-second slots, so every operation is O(1) in the number of lobbies.
+class LobbyRegistry {
+public:
+    explicit LobbyRegistry(double heartbeatTimeout = 30.0)
+        : timeout(heartbeatTimeout), wheel(WheelSlots(heartbeatTimeout)) {}
+
+    // A host registers one lobby; registering again replaces the previous one.
+    // A host coming back after a master restart reclaims its provisional lobby and keeps its id.
+    uint32_t Register(ActiveLobby lobby) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto existing = byHost.find(HostKey(lobby.shard, lobby.peerId));
+        if (existing != byHost.end()) Erase(existing->second);
+
+        auto restored = provisionalByEndpoint.find(EndpointKey(lobby.ip, lobby.port));
+        if (restored != provisionalByEndpoint.end()) {
+            lobby.id = restored->second;
+            Erase(lobby.id);
+        }
+        else lobby.id = nextLobbyId++;
+        lobby.provisional = false;
+        lobbies[lobby.id] = lobby;
+        byHost[HostKey(lobby.shard, lobby.peerId)] = lobby.id;
+        shardCounts[lobby.shard]++;
+        Schedule(lobby.id, lobby.lastHeartbeatTime);
+        version++;
+        return lobby.id;
+    }
+
+    bool Find(uint32_t lobbyId, ActiveLobby& out) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = lobbies.find(lobbyId);
+        if (it == lobbies.end()) return false;
+        out = it->second;
+        return true;
+    }
+
+    bool FindByHost(int shard, uint32_t peerId, uint32_t& lobbyId) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        auto it = byHost.find(HostKey(shard, peerId));
+        if (it == byHost.end()) return false;
+        lobbyId = it->second;
+        return true;
+    }
+
+    // Returns the names of the removed lobbies for logging
+    std::vector<std::string> RemoveByHost(int shard, uint32_t peerId) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        std::vector<std::string> removed;
+        auto it = byHost.find(HostKey(shard, peerId));
+        if (it == byHost.end()) return removed;
+        removed.push_back(lobbies[it->second].name);
+        Erase(it->second);
+        return removed;
+    }
+
+    bool Heartbeat(int shard, uint32_t peerId, uint8_t currentPlayers, uint8_t wave, double now) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        auto it = byHost.find(HostKey(shard, peerId));
+        if (it == byHost.end()) return false;
+        ActiveLobby& lobby = lobbies[it->second];
+        if (lobby.currentPlayers != currentPlayers || lobby.wave != wave) version++;
+        lobby.currentPlayers = currentPlayers;
+        lobby.wave = wave;
+        lobby.lastHeartbeatTime = now;
+        // The old wheel entry is left behind and ignored once it comes due
+        Schedule(lobby.id, now);
+        return true;
+    }
+
+    // Advances the wheel to now, dropping lobbies whose heartbeat is older than the timeout
+    std::vector<std::string> Expire(double now) {
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        std::vector<std::string> expired;
+        int64_t target = (int64_t)std::floor(now);
+        if (wheelTick < 0 || target - wheelTick > (int64_t)wheel.size()) wheelTick = target - (int64_t)wheel.size();
+
+        for (; wheelTick <= target; wheelTick++) {
+            auto& slot = wheel[(size_t)(wheelTick % (int64_t)wheel.size())];
+            std::vector<uint32_t> keep;
+            for (uint32_t lobbyId : slot) {
+                auto it = lobbies.find(lobbyId);
+                if (it == lobbies.end()) continue;
+                double deadline = it->second.lastHeartbeatTime + timeout;
+                if (deadline > now) {
+                    // Still due in this slot's next turn; later heartbeats have their own entry
+                    if ((int64_t)std::floor(deadline) % (int64_t)wheel.size() == wheelTick % (int64_t)wheel.size()) keep.push_back(lobbyId);
+                    continue;
+                }
+                expired.push_back(it->second.name);
+                Erase(lobbyId);
+            }
+            slot.swap(keep);
+        }
+        wheelTick = target;
+        return expired;
+    }
+
+    // Returns the list for the current version, rebuilding it at most every LIST_REBUILD_INTERVAL
+    // so a busy fleet's constant heartbeats don't turn every request into a rebuild
+    std::shared_ptr<const LobbyListCache> GetList(double now) const {
+        std::lock_guard<std::mutex> cacheLock(listMutex);
+        if (listCache && (listCache->version == version || now - listCache->buildTime < LIST_REBUILD_INTERVAL)) return listCache;
+
+        auto cache = std::make_shared<LobbyListCache>();
+        cache->buildTime = now;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            cache->version = version;
+            cache->lobbies.reserve(lobbies.size());
+            for (const auto& pair : lobbies) cache->lobbies.push_back(ToInfo(pair.second));
+        }
+        std::sort(cache->lobbies.begin(), cache->lobbies.end(), [](const LobbyInfo& a, const LobbyInfo& b) { return a.id < b.id; });
+        cache->BuildPages();
+        listCache = cache;
+        return listCache;
+    }
+
+    uint32_t Version() const { return version; }
+
+    // Writes the registry to a temp file and renames it over path, so a crash mid-write
+    // never leaves a truncated snapshot behind
+    bool SaveSnapshot(const std::string& path, uint64_t wallTime) const {
+        LobbySnapshotFile file;
+        file.savedAt = wallTime;
+        {
+            std::shared_lock<std::shared_mutex> lock(mutex);
+            file.nextLobbyId = nextLobbyId;
+            file.version = version;
+            file.lobbies.reserve(lobbies.size());
+            for (const auto& pair : lobbies) file.lobbies.push_back(ToInfo(pair.second));
+        }
+
+        Buffer buf; OutputAdapter ad(buf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+        ser.object(file); ser.adapter().flush();
+
+        std::string tempPath = path + ".tmp";
+        {
+            std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+            if (!out) return false;
+            out.write((const char*)buf.data(), (std::streamsize)buf.size());
+            out.flush();
+            if (!out) return false;
+        }
+        std::error_code ec;
+        std::filesystem::rename(tempPath, path, ec);
+        return !ec;
+    }
+
+    // Restores lobbies from a snapshot as provisional, with a full heartbeat timeout for their
+    // hosts to reconnect. Snapshots older than the timeout are ignored. Returns the number restored.
+    size_t LoadSnapshot(const std::string& path, double now, uint64_t wallTime) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) return 0;
+        Buffer buf((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+        LobbySnapshotFile file;
+        InputAdapter ia(buf.begin(), buf.end());
+        bitsery::Deserializer<InputAdapter> des(std::move(ia));
+        des.object(file);
+        if (des.adapter().error() != bitsery::ReaderError::NoError) return 0;
+        if (file.magic != LobbySnapshotFile::MAGIC || file.format != LobbySnapshotFile::FORMAT) return 0;
+        if (wallTime < file.savedAt || (double)(wallTime - file.savedAt) >= timeout) return 0;
+
+        std::unique_lock<std::shared_mutex> lock(mutex);
+        size_t restored = 0;
+        for (const auto& info : file.lobbies) {
+            if (lobbies.count(info.id)) continue;
+            ActiveLobby lobby;
+            lobby.id = info.id;
+            lobby.name = info.name;
+            lobby.ip = info.ip;
+            lobby.port = info.port;
+            lobby.currentPlayers = info.currentPlayers;
+            lobby.maxPlayers = info.maxPlayers;
+            lobby.wave = info.wave;
+            lobby.relayPort = info.relayPort;
+            lobby.lastHeartbeatTime = now;
+            lobby.peerId = 0;
+            lobby.shard = -1;
+            lobby.provisional = true;
+            lobbies[lobby.id] = lobby;
+            provisionalByEndpoint[EndpointKey(lobby.ip, lobby.port)] = lobby.id;
+            Schedule(lobby.id, now);
+            restored++;
+        }
+        nextLobbyId = std::max(nextLobbyId, file.nextLobbyId);
+        // Past any version a client may have cached from the previous run
+        version = std::max(version.load(), file.version) + 1;
+        return restored;
+    }
+
+    std::vector<size_t> CountPerShard(int numShards) const {
+        std::shared_lock<std::shared_mutex> lock(mutex);
+        std::vector<size_t> counts(numShards, 0);
+        for (const auto& [shard, count] : shardCounts) {
+            if (shard >= 0 && shard < numShards) counts[shard] = count;
+        }
+        return counts;
+    }
+
+private:
+    static uint64_t HostKey(int shard, uint32_t peerId) {
+        return ((uint64_t)(uint32_t)shard << 32) | peerId;
+    }
+
+    static std::string EndpointKey(const std::string& ip, uint16_t port) {
+        return ip + ":" + std::to_string(port);
+    }
+
+    static LobbyInfo ToInfo(const ActiveLobby& lobby) {
+        LobbyInfo info;
+        info.id = lobby.id;
+        info.name = lobby.name;
+        info.ip = lobby.ip;
+        info.port = lobby.port;
+        info.currentPlayers = lobby.currentPlayers;
+        info.maxPlayers = lobby.maxPlayers;
+        info.wave = lobby.wave;
+        info.relayPort = lobby.relayPort;
+        return info;
+    }
+
+    // One slot per second with headroom, so a deadline never wraps onto the slot being processed
+    static size_t WheelSlots(double timeout) {
+        return (size_t)std::ceil(timeout) + 8;
+    }
+
+    void Schedule(uint32_t lobbyId, double heartbeatTime) {
+        int64_t tick = (int64_t)std::floor(heartbeatTime + timeout);
+        wheel[(size_t)(tick % (int64_t)wheel.size())].push_back(lobbyId);
+    }
+
+    void Erase(uint32_t lobbyId) {
+        auto it = lobbies.find(lobbyId);
+        if (it == lobbies.end()) return;
+        if (it->second.provisional) {
+            provisionalByEndpoint.erase(EndpointKey(it->second.ip, it->second.port));
+        }
+        else {
+            byHost.erase(HostKey(it->second.shard, it->second.peerId));
+            auto count = shardCounts.find(it->second.shard);
+            if (count != shardCounts.end() && --count->second == 0) shardCounts.erase(count);
+        }
+        lobbies.erase(it);
+        version++;
+    }
+
+    mutable std::shared_mutex mutex;
+    std::unordered_map<uint32_t, ActiveLobby> lobbies;
+    std::unordered_map<uint64_t, uint32_t> byHost;
+    std::unordered_map<int, size_t> shardCounts;
+    std::unordered_map<std::string, uint32_t> provisionalByEndpoint;
+    uint32_t nextLobbyId = 1;
+    // Bumped on every change visible in the lobby list; 0 is never used so clients can send it as "none"
+    std::atomic<uint32_t> version{ 1 };
+
+    const double LIST_REBUILD_INTERVAL = 0.5;
+    mutable std::mutex listMutex;
+    mutable std::shared_ptr<const LobbyListCache> listCache;
+
+    double timeout;
+    std::vector<std::vector<uint32_t>> wheel;
+    int64_t wheelTick = -1;
+};
@@ -0,0 +1,263 @@
+﻿#include "MasterShard.h"
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+double GetTime() {
+    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+}
+
+MasterShard::MasterShard(int index, uint16_t port, LobbyRegistry& registry, std::vector<std::unique_ptr<MasterShard>>& shards)
+    : index(index), port(port), registry(registry), shards(shards) {
+    server = ENetServer::alloc();
+}
+
+MasterShard::~MasterShard() {
+    Stop();
+}
+
+bool MasterShard::Start(uint32_t maxPeers) {
+    if (!server->start(port, maxPeers)) return false;
+
+    server->onRawPacket([this](uint32_t peerId, ENetPacket* packet) {
+        return ForwardRelayPacket(peerId, packet);
+    });
+
+    running = true;
+    thread = std::thread(&MasterShard::Loop, this);
+    return true;
+}
+
+void MasterShard::Stop() {
+    running = false;
+    if (thread.joinable()) thread.join();
+    server->stop();
+}
+
+void MasterShard::Post(uint32_t peerId, DeliveryType type, StreamBuffer::Shared stream) {
+    std::lock_guard<std::mutex> lock(postedMutex);
+    posted.push_back({ peerId, type, stream });
+}
+
+void MasterShard::FlushPosted() {
+    std::vector<PostedPacket> pending;
+    {
+        std::lock_guard<std::mutex> lock(postedMutex);
+        pending.swap(posted);
+    }
+    for (auto& p : pending) server->send(p.peerId, p.type, p.stream);
+}
+
+void MasterShard::Loop() {
+    while (running && server->isRunning()) {
+        FlushPosted();
+
+        auto msgs = server->poll();
+        double now = GetTime();
+
+        for (auto& msg : msgs) {
+            uint32_t peerId = msg->peerId();
+
+            if (msg->type() == MessageType::DISCONNECT) {
+                relayAccounting.RemovePeer(peerId);
+                for (const auto& name : registry.RemoveByHost(index, peerId)) {
+                    std::cout << "Lobby removed (Host Disconnect): " << name << "\n";
+                }
+            }
+            else if (msg->type() == MessageType::DATA) {
+                HandleMessage(peerId, msg->stream(), now);
+            }
+        }
+
+        if (now - lastStatsDump >= STATS_DUMP_INTERVAL) {
+            if (lastStatsDump > 0.0) DumpRelayStats();
+            lastStatsDump = now;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// New lobbies go to the shard with the fewest, so relay load spreads across threads
+int MasterShard::PickShardForNewLobby() const {
+    auto counts = registry.CountPerShard((int)shards.size());
+    return (int)(std::min_element(counts.begin(), counts.end()) - counts.begin());
+}
+
+void MasterShard::HandleMessage(uint32_t peerId, StreamBuffer::Shared stream, double now) {
+    const auto& buf = stream->buffer();
+    size_t offset = stream->tellg();
+    if (buf.empty() || offset >= buf.size()) return;
+
+    InputAdapter ia(buf.begin() + offset, buf.end());
+    bitsery::Deserializer<InputAdapter> des(std::move(ia));
+    uint8_t type; des.value1b(type);
+
+    if (type == GamePacket::MASTER_REGISTER) {
+        MasterRegisterPacket pkt; des.object(pkt);
+        if (des.adapter().error() != bitsery::ReaderError::NoError) return;
+
+        // Only the entry shard redirects, so a host is never bounced twice
+        int target = (index == 0) ? PickShardForNewLobby() : index;
+        if (target != index) {
+            MasterRedirectPacket redirect;
+            redirect.port = shards[target]->GetPort();
+            Buffer outBuf; OutputAdapter ad(outBuf); bitsery::Serializer<OutputAdapter> ser(std::move(ad));
+            ser.value1b(GamePacket::MASTER_REDIRECT); ser.object(redirect); ser.adapter().flush();
+            server->send(peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(outBuf.data(), outBuf.size()));
+            std::cout << "Lobby '" << pkt.serverName << "' redirected to shard " << target << "\n";
+            return;
+        }
+
+        ActiveLobby lobby;
+        lobby.peerId = peerId;
+        lobby.shard = index;
+        lobby.relayPort = port;
+        lobby.port = pkt.gamePort;
+        lobby.name = pkt.serverName;
+        lobby.maxPlayers = pkt.maxPlayers;
+        lobby.currentPlayers = 0;
+        lobby.wave = 1;
+        lobby.lastHeartbeatTime = now;
+        lobby.ip = server->getPeerIP(peerId);
+        uint32_t lobbyId = registry.Register(lobby);
+        std::cout << "Lobby Registered: " << lobby.name << " (ID: " << lobbyId << ", Shard: " << index << ") Public IP: " << lobby.ip << "\n";
+    }
+    else if (type == GamePacket::P2P_REQUEST) {
+        P2PRequestPacket req; des.object(req);
+        if (des.adapter().error() != bitsery::ReaderError::NoError) return;
+
+        ActiveLobby targetLobby;
+        if (!registry.Find(req.lobbyId, targetLobby)) return;
+
+        std::string playerIp = server->getPeerIP(peerId);
+        uint16_t playerPort = server->getPeerPort(peerId);
+
+        if (targetLobby.ip.empty() || targetLobby.ip == "Unknown") {
+            std::cout << "[P2P] Error: Host IP is unknown\n";
+            return;
+        }
+
+        P2PSignalPacket sigToPlayer;
+        sigToPlayer.publicIp = targetLobby.ip;
+        sigToPlayer.publicPort = targetLobby.port;
+        sigToPlayer.isHost = false;
+
+        Buffer bufP; OutputAdapter adP(bufP); bitsery::Serializer<OutputAdapter> serP(std::move(adP));
+        serP.value1b(GamePacket::P2P_SIGNAL); serP.object(sigToPlayer); serP.adapter().flush();
+        server->send(peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(bufP.data(), bufP.size()));
+
+        P2PSignalPacket sigToHost;
+        sigToHost.publicIp = playerIp;
+        sigToHost.publicPort = playerPort;
+        sigToHost.isHost = true;
+
+        Buffer bufH; OutputAdapter adH(bufH); bitsery::Serializer<OutputAdapter> serH(std::move(adH));
+        serH.value1b(GamePacket::P2P_SIGNAL); serH.object(sigToHost); serH.adapter().flush();
+        auto hostStream = StreamBuffer::alloc(bufH.data(), bufH.size());
+        // A provisional lobby's host hasn't reconnected yet; the player still gets the host address
+        if (!targetLobby.provisional) {
+            if (targetLobby.shard == index) server->send(targetLobby.peerId, DeliveryType::RELIABLE, hostStream);
+            else shards[targetLobby.shard]->Post(targetLobby.peerId, DeliveryType::RELIABLE, hostStream);
+        }
+
+        std::cout << "[P2P Signaling] Player " << playerIp << ":" << playerPort
+            << " <-> Host " << targetLobby.ip << ":" << targetLobby.port << "\n";
+    }
+    else if (type == GamePacket::MASTER_HEARTBEAT) {
+        MasterHeartbeatPacket pkt; des.object(pkt);
+        if (des.adapter().error() == bitsery::ReaderError::NoError) {
+            registry.Heartbeat(index, peerId, pkt.currentPlayers, pkt.wave, now);
+        }
+    }
+    else if (type == GamePacket::MASTER_LIST_REQ) {
+        MasterListReqPacket req; des.object(req);
+        // Older clients send the request without a body
+        if (des.adapter().error() != bitsery::ReaderError::NoError) req = MasterListReqPacket();
+        server->send(peerId, DeliveryType::RELIABLE, registry.GetList(now)->Query(req));
+    }
+}
+
+// Relay traffic is forwarded as the original ENet packet: only the fixed RelayPacket header
+// is read and the target id rewritten in place, the payload is never copied.
+bool MasterShard::ForwardRelayPacket(uint32_t peerId, ENetPacket* packet) {
+    if (packet->dataLength > RelayHeader::TYPE_OFFSET && packet->data[RelayHeader::TYPE_OFFSET] == GamePacket::RELAY_MULTICAST) {
+        FanOutMulticast(peerId, packet);
+        return true;
+    }
+
+    uint8_t type; uint32_t targetId; bool isReliable;
+    if (!RelayHeader::Parse(packet->data, packet->dataLength, type, targetId, isReliable)) return false;
+    if (type != GamePacket::RELAY_TO_SERVER && type != GamePacket::RELAY_TO_CLIENT) return false;
+
+    uint32_t destPeerId;
+    uint32_t lobbyId;
+    if (type == GamePacket::RELAY_TO_SERVER) {
+        ActiveLobby lobby;
+        // A relay session is pinned to the shard of its lobby host; other shards can't reach it
+        if (!registry.Find(targetId, lobby) || lobby.shard != index) return true;
+        destPeerId = lobby.peerId;
+        lobbyId = lobby.id;
+    }
+    else {
+        // Only lobby hosts may send to relay clients
+        if (!registry.FindByHost(index, peerId, lobbyId)) return true;
+        destPeerId = targetId & ~RELAY_ID_MASK;
+    }
+
+    if (!relayAccounting.Admit(lobbyId, peerId, packet->dataLength, packet->dataLength, isReliable, GetTime())) return true;
+    RelayHeader::WriteTargetId(packet->data, (type == GamePacket::RELAY_TO_SERVER) ? (peerId | RELAY_ID_MASK) : 0);
+
+    server->forward(destPeerId, isReliable ? DeliveryType::RELIABLE : DeliveryType::UNRELIABLE, packet);
+    return true;
+}
+
+// Rewrites a RELAY_MULTICAST into a single RELAY_TO_CLIENT packet (the target id is always 0
+// on the client side) and queues that same ENet packet to every target peer.
+void MasterShard::FanOutMulticast(uint32_t peerId, ENetPacket* packet) {
+    const uint8_t* in = packet->data;
+    size_t length = packet->dataLength;
+    if (length < RelayHeader::MULTICAST_TARGETS_OFFSET) return;
+
+    size_t count = in[RelayHeader::MULTICAST_COUNT_OFFSET];
+    size_t payloadOffset = RelayHeader::MULTICAST_TARGETS_OFFSET + count * 4;
+    if (count == 0 || length < payloadOffset) return;
+
+    bool isReliable = in[RelayHeader::TYPE_OFFSET + 1] != 0;
+    uint8_t compression = in[RelayHeader::TYPE_OFFSET + 2];
+
+    size_t payloadSize = length - payloadOffset;
+    uint32_t lobbyId;
+    if (!registry.FindByHost(index, peerId, lobbyId)) return;
+    if (!relayAccounting.Admit(lobbyId, peerId, length, (RelayHeader::SIZE + payloadSize) * count, isReliable, GetTime())) return;
+    ENetPacket* out = enet_packet_create(nullptr, RelayHeader::SIZE + payloadSize, 0);
+    if (!out) return;
+    std::memcpy(out->data, in, Message::HEADER_SIZE);
+    out->data[RelayHeader::TYPE_OFFSET] = GamePacket::RELAY_TO_CLIENT;
+    RelayHeader::WriteTargetId(out->data, 0);
+    out->data[RelayHeader::RELIABLE_OFFSET] = isReliable ? 1 : 0;
+    out->data[RelayHeader::RELIABLE_OFFSET + 1] = compression;
+    std::memcpy(out->data + RelayHeader::SIZE, in + payloadOffset, payloadSize);
+
+    DeliveryType type = isReliable ? DeliveryType::RELIABLE : DeliveryType::UNRELIABLE;
+    for (size_t i = 0; i < count; i++) {
+        uint32_t targetId = RelayHeader::ReadTargetAt(in, RelayHeader::MULTICAST_TARGETS_OFFSET + i * 4);
+        server->forward(targetId & ~RELAY_ID_MASK, type, out);
+    }
+    if (out->referenceCount == 0) enet_packet_destroy(out);
+}
+
+void MasterShard::DumpRelayStats() {
+    auto top = relayAccounting.TakeTopLobbies(STATS_TOP_LOBBIES);
+    if (top.empty()) return;
+
+    std::cout << "[Relay] Shard " << index << " top lobbies over the last " << STATS_DUMP_INTERVAL << "s:\n";
+    for (const auto& s : top) {
+        ActiveLobby lobby;
+        std::string name = registry.Find(s.lobbyId, lobby) ? lobby.name : "(closed)";
+        std::cout << "  #" << s.lobbyId << " " << name
+            << ": in " << (s.bytesIn / 1024) << " KB, out " << (s.bytesOut / 1024) << " KB, "
+            << s.packets << " pkts, dropped " << s.droppedPackets << " pkts / " << (s.droppedBytes / 1024) << " KB, "
+            << ((s.bytesIn + s.bytesOut) / STATS_DUMP_INTERVAL / 1024.0) << " KB/s\n";
+    }
+}
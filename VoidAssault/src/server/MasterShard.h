@@ -0,0 +1,62 @@
+﻿#pragma once
+#include "../common/enet/ENetServer.h"
+#include "LobbyRegistry.h"
+#include "RelayAccounting.h"
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+const uint32_t RELAY_ID_MASK = 0x80000000;
+
+double GetTime();
+
+// One ENet host on its own port and thread. Every shard answers lobby list, registration
+// and P2P requests from the shared registry; relay traffic stays on the shard the lobby
+// host is connected to, so clients relay through LobbyInfo::relayPort.
+class MasterShard {
+public:
+    MasterShard(int index, uint16_t port, LobbyRegistry& registry, std::vector<std::unique_ptr<MasterShard>>& shards);
+    ~MasterShard();
+
+    bool Start(uint32_t maxPeers);
+    void Stop();
+
+    int GetIndex() const { return index; }
+    uint16_t GetPort() const { return port; }
+
+    // Thread-safe: queues a packet for one of this shard's peers, sent from the shard's own thread
+    void Post(uint32_t peerId, DeliveryType type, StreamBuffer::Shared stream);
+
+private:
+    struct PostedPacket {
+        uint32_t peerId;
+        DeliveryType type;
+        StreamBuffer::Shared stream;
+    };
+
+    void Loop();
+    void FlushPosted();
+    void HandleMessage(uint32_t peerId, StreamBuffer::Shared stream, double now);
+    bool ForwardRelayPacket(uint32_t peerId, ENetPacket* packet);
+    void FanOutMulticast(uint32_t peerId, ENetPacket* packet);
+    void DumpRelayStats();
+    int PickShardForNewLobby() const;
+
+    int index;
+    uint16_t port;
+    LobbyRegistry& registry;
+    std::vector<std::unique_ptr<MasterShard>>& shards;
+
+    ENetServer::Shared server;
+    std::thread thread;
+    std::atomic<bool> running{ false };
+
+    RelayAccounting relayAccounting;
+    double lastStatsDump = 0.0;
+    const double STATS_DUMP_INTERVAL = 60.0;
+    const size_t STATS_TOP_LOBBIES = 10;
+
+    std::mutex postedMutex;
+    std::vector<PostedPacket> posted;
+};
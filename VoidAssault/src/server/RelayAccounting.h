@@ -0,0 +1,126 @@
+﻿#pragma once
+#include "../common/NetworkPackets.h"
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+struct RelayLimits {
+    // Sustained relay bandwidth for all traffic of one lobby, both directions
+    double lobbyBytesPerSecond = 2.0 * 1024 * 1024;
+    // Sustained upload of a single peer into the relay
+    double peerBytesPerSecond = 512.0 * 1024;
+    // Bucket depth, in seconds of the sustained rate
+    double burstSeconds = 0.5;
+    // Larger unreliable relay packets are dropped; reliable ones are forwarded regardless,
+    // see TokenBucket::Consume
+    size_t maxPacketBytes = RELAY_MAX_PACKET_BYTES;
+};
+
+class TokenBucket {
+public:
+    void Configure(double bytesPerSecond, double burstBytes, double now) {
+        rate = bytesPerSecond;
+        burst = burstBytes;
+        tokens = burstBytes;
+        last = now;
+    }
+
+    // Unreliable traffic is dropped when the bucket is empty. Reliable traffic can't be
+    // dropped without breaking its stream, so it is always admitted and runs the bucket
+    // into debt, which then holds back the sender's unreliable traffic until it is repaid.
+    bool Consume(double bytes, bool reliable, double now) {
+        tokens = std::min(burst, tokens + (now - last) * rate);
+        last = now;
+        if (!reliable && tokens < bytes) return false;
+        tokens -= bytes;
+        return true;
+    }
+
+private:
+    double rate = 0.0;
+    double burst = 0.0;
+    double tokens = 0.0;
+    double last = 0.0;
+};
+
+// Per-shard relay accounting; only touched from the shard's own thread.
+class RelayAccounting {
+public:
+    struct LobbyStats {
+        uint32_t lobbyId = 0;
+        uint64_t bytesIn = 0;
+        uint64_t bytesOut = 0;
+        uint64_t packets = 0;
+        uint64_t droppedBytes = 0;
+        uint64_t droppedPackets = 0;
+    };
+
+    explicit RelayAccounting(const RelayLimits& limits = RelayLimits()) : limits(limits) {}
+
+    // bytesOut is what the master sends for this packet (payload times the number of targets)
+    bool Admit(uint32_t lobbyId, uint32_t senderPeerId, size_t bytesIn, size_t bytesOut, bool reliable, double now) {
+        Lobby& lobby = Touch(lobbies, lobbyId, limits.lobbyBytesPerSecond, now);
+        Peer& peer = Touch(peers, senderPeerId, limits.peerBytesPerSecond, now);
+        lobby.stats.lobbyId = lobbyId;
+
+        bool admitted = (reliable || bytesIn <= limits.maxPacketBytes)
+            && peer.bucket.Consume((double)bytesIn, reliable, now)
+            && lobby.bucket.Consume((double)(bytesIn + bytesOut), reliable, now);
+
+        if (admitted) {
+            lobby.stats.bytesIn += bytesIn;
+            lobby.stats.bytesOut += bytesOut;
+            lobby.stats.packets++;
+        }
+        else {
+            lobby.stats.droppedBytes += bytesIn;
+            lobby.stats.droppedPackets++;
+        }
+        return admitted;
+    }
+
+    void RemovePeer(uint32_t peerId) { peers.erase(peerId); }
+
+    // Returns the busiest lobbies since the last call and resets the interval counters;
+    // lobbies without traffic in the interval are forgotten
+    std::vector<LobbyStats> TakeTopLobbies(size_t count) {
+        std::vector<LobbyStats> all;
+        for (auto it = lobbies.begin(); it != lobbies.end(); ) {
+            const LobbyStats& s = it->second.stats;
+            if (s.packets == 0 && s.droppedPackets == 0) {
+                it = lobbies.erase(it);
+                continue;
+            }
+            all.push_back(s);
+            it->second.stats = LobbyStats();
+            ++it;
+        }
+        auto total = [](const LobbyStats& s) { return s.bytesIn + s.bytesOut; };
+        std::sort(all.begin(), all.end(), [&](const LobbyStats& a, const LobbyStats& b) { return total(a) > total(b); });
+        if (all.size() > count) all.resize(count);
+        return all;
+    }
+
+private:
+    struct Lobby {
+        TokenBucket bucket;
+        LobbyStats stats;
+    };
+    struct Peer {
+        TokenBucket bucket;
+    };
+
+    template <typename T>
+    T& Touch(std::unordered_map<uint32_t, T>& map, uint32_t id, double rate, double now) {
+        auto it = map.find(id);
+        if (it != map.end()) return it->second;
+        T& entry = map[id];
+        entry.bucket.Configure(rate, rate * limits.burstSeconds, now);
+        return entry;
+    }
+
+    RelayLimits limits;
+    std::unordered_map<uint32_t, Lobby> lobbies;
+    std::unordered_map<uint32_t, Peer> peers;
+};
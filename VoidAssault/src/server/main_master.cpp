@@ -1,235 +1,75 @@
-﻿#include "../common/enet/ENetServer.h"
-#include "../common/NetworkPackets.h"
+﻿#include "MasterShard.h"
 #include <iostream>
-#include <map>
 #include <string>
 #include <thread>
 #include <chrono>
-#include <mutex>
+#include <algorithm>
+#include <ctime>
+#include <atomic>
+#include <csignal>
 
-const uint32_t RELAY_ID_MASK = 0x80000000;
+std::atomic<bool> keepRunning{ true };
 
-struct ActiveLobby {
-    uint32_t id;
-    std::string ip;
-    uint16_t port;
-    std::string name;
-    uint8_t currentPlayers;
-    uint8_t maxPlayers;
-    uint8_t wave;
-    double lastHeartbeatTime;
-    uint32_t peerId;
-};
-
-std::map<uint32_t, ActiveLobby> lobbies;
-std::mutex lobbyMutex;
-uint32_t nextLobbyId = 1;
-
-double GetTime() {
-    return std::chrono::duration<double>(std::chrono::high_resolution_clock::now().time_since_epoch()).count();
+void SignalHandler(int signum) {
+    keepRunning = false;
 }
 
+// Usage: MasterServer [basePort] [shards] [snapshotFile]
+// Shard i listens on basePort + i; hosts and clients always enter through basePort.
+// The registry is snapshotted to snapshotFile and reloaded on start, so a restart doesn't
+// empty the lobby list while hosts reconnect.
 int main(int argc, char** argv) {
     if (enet_initialize() != 0) return 1;
-
-    ENetServer::Shared server = ENetServer::alloc();
-    if (server->start(8080, 2048)) {
-        std::cout << "MASTER SERVER: Started on port 8080" << std::endl;
+    signal(SIGINT, SignalHandler);
+    signal(SIGTERM, SignalHandler);
+
+    int basePort = (argc > 1) ? std::atoi(argv[1]) : 8080;
+    int numShards = (argc > 2) ? std::atoi(argv[2]) : (int)std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    numShards = std::clamp(numShards, 1, 64);
+    std::string snapshotPath = (argc > 3) ? argv[3] : "master_lobbies.bin";
+    const uint32_t maxPeersPerShard = 2048;
+    const double SNAPSHOT_INTERVAL = 5.0;
+
+    LobbyRegistry registry;
+    size_t restored = registry.LoadSnapshot(snapshotPath, GetTime(), (uint64_t)std::time(nullptr));
+    if (restored > 0) std::cout << "MASTER SERVER: Restored " << restored << " provisional lobbies from " << snapshotPath << std::endl;
+
+    std::vector<std::unique_ptr<MasterShard>> shards;
+    for (int i = 0; i < numShards; i++) {
+        shards.push_back(std::make_unique<MasterShard>(i, (uint16_t)(basePort + i), registry, shards));
     }
-    else {
-        return -1;
+    for (auto& shard : shards) {
+        if (!shard->Start(maxPeersPerShard)) {
+            std::cout << "MASTER SERVER: Failed to start shard on port " << shard->GetPort() << std::endl;
+            for (auto& s : shards) s->Stop();
+            enet_deinitialize();
+            return -1;
+        }
     }
+    std::cout << "MASTER SERVER: Started on port " << basePort << " with " << numShards << " shard(s)" << std::endl;
 
-    while (server->isRunning()) {
-        auto msgs = server->poll();
+    double lastSnapshot = GetTime();
+    uint32_t savedVersion = registry.Version();
+    while (keepRunning) {
         double now = GetTime();
-
-        for (auto& msg : msgs) {
-            uint32_t peerId = msg->peerId();
-
-            if (msg->type() == MessageType::DISCONNECT) {
-                std::lock_guard<std::mutex> lock(lobbyMutex);
-                for (auto it = lobbies.begin(); it != lobbies.end(); ) {
-                    if (it->second.peerId == peerId) {
-                        std::cout << "Lobby removed (Host Disconnect): " << it->second.name << "\n";
-                        it = lobbies.erase(it);
-                    }
-                    else {
-                        ++it;
-                    }
-                }
-            }
-            else if (msg->type() == MessageType::DATA) {
-                const auto& buf = msg->stream()->buffer();
-                size_t offset = msg->stream()->tellg();
-                if (!buf.empty() && offset < buf.size()) {
-                    InputAdapter ia(buf.begin() + offset, buf.end());
-                    bitsery::Deserializer<InputAdapter> des(std::move(ia));
-                    uint8_t type; des.value1b(type);
-
-                    if (type == GamePacket::MASTER_REGISTER) {
-                        MasterRegisterPacket pkt; des.object(pkt);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            std::lock_guard<std::mutex> lock(lobbyMutex);
-                            ActiveLobby lobby;
-                            lobby.id = nextLobbyId++;
-                            lobby.peerId = peerId;
-                            lobby.port = pkt.gamePort;
-                            lobby.name = pkt.serverName;
-                            lobby.maxPlayers = pkt.maxPlayers;
-                            lobby.currentPlayers = 0;
-                            lobby.wave = 1;
-                            lobby.lastHeartbeatTime = now;
-
-                            lobby.ip = server->getPeerIP(peerId);
-                            lobbies[lobby.id] = lobby;
-                            std::cout << "Lobby Registered: " << lobby.name << " (ID: " << lobby.id << ") Public IP: " << lobby.ip << "\n";
-                        }
-                    }
-                    else if (type == GamePacket::P2P_REQUEST) {
-                        P2PRequestPacket req; des.object(req);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            std::lock_guard<std::mutex> lock(lobbyMutex);
-                            if (lobbies.count(req.lobbyId)) {
-                                ActiveLobby& targetLobby = lobbies[req.lobbyId];
-
-                                std::string playerIp = server->getPeerIP(peerId);
-                                uint16_t playerPort = server->getPeerPort(peerId);
-
-                                if (targetLobby.ip.empty() || targetLobby.ip == "Unknown") {
-                                    std::cout << "[P2P] Error: Host IP is unknown\n";
-                                    continue;
-                                }
-
-                                P2PSignalPacket sigToPlayer;
-                                sigToPlayer.publicIp = targetLobby.ip;
-                                sigToPlayer.publicPort = targetLobby.port;
-                                sigToPlayer.isHost = false;
-
-                                Buffer bufP; OutputAdapter adP(bufP); bitsery::Serializer<OutputAdapter> serP(std::move(adP));
-                                serP.value1b(GamePacket::P2P_SIGNAL); serP.object(sigToPlayer); serP.adapter().flush();
-                                server->send(peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(bufP.data(), bufP.size()));
-
-                                P2PSignalPacket sigToHost;
-                                sigToHost.publicIp = playerIp;
-                                sigToHost.publicPort = playerPort;
-                                sigToHost.isHost = true;
-
-                                Buffer bufH; OutputAdapter adH(bufH); bitsery::Serializer<OutputAdapter> serH(std::move(adH));
-                                serH.value1b(GamePacket::P2P_SIGNAL); serH.object(sigToHost); serH.adapter().flush();
-                                server->send(targetLobby.peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(bufH.data(), bufH.size()));
-
-                                std::cout << "[P2P Signaling] Player " << playerIp << ":" << playerPort
-                                    << " <-> Host " << targetLobby.ip << ":" << targetLobby.port << "\n";
-                            }
-                        }
-                    }
-                    else if (type == GamePacket::RELAY_TO_SERVER) {
-                        RelayPacket relayPkt; des.object(relayPkt);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            uint32_t serverPeerId = 0;
-                            bool found = false;
-                            {
-                                std::lock_guard<std::mutex> lock(lobbyMutex);
-                                if (lobbies.count(relayPkt.targetId)) {
-                                    serverPeerId = lobbies[relayPkt.targetId].peerId;
-                                    found = true;
-                                }
-                            }
-
-                            if (found) {
-                                RelayPacket fwdPkt;
-                                fwdPkt.targetId = peerId | RELAY_ID_MASK;
-                                fwdPkt.isReliable = relayPkt.isReliable;
-                                fwdPkt.data = std::move(relayPkt.data);
-
-                                Buffer fwdBuf; OutputAdapter ad(fwdBuf);
-                                bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-                                ser.value1b(GamePacket::RELAY_TO_SERVER);
-                                ser.object(fwdPkt);
-                                ser.adapter().flush();
-
-                                DeliveryType dType = relayPkt.isReliable ? DeliveryType::RELIABLE : DeliveryType::UNRELIABLE;
-                                server->send(serverPeerId, dType, StreamBuffer::alloc(fwdBuf.data(), fwdBuf.size()));
-                            }
-                        }
-                    }
-                    else if (type == GamePacket::RELAY_TO_CLIENT) {
-                        RelayPacket relayPkt; des.object(relayPkt);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            uint32_t targetClientPeerId = relayPkt.targetId & ~RELAY_ID_MASK;
-
-                            RelayPacket fwdPkt;
-                            fwdPkt.targetId = 0;
-                            fwdPkt.isReliable = relayPkt.isReliable;
-                            fwdPkt.data = std::move(relayPkt.data);
-
-                            Buffer fwdBuf; OutputAdapter ad(fwdBuf);
-                            bitsery::Serializer<OutputAdapter> ser(std::move(ad));
-                            ser.value1b(GamePacket::RELAY_TO_CLIENT);
-                            ser.object(fwdPkt);
-                            ser.adapter().flush();
-
-                            DeliveryType dType = relayPkt.isReliable ? DeliveryType::RELIABLE : DeliveryType::UNRELIABLE;
-                            server->send(targetClientPeerId, dType, StreamBuffer::alloc(fwdBuf.data(), fwdBuf.size()));
-                        }
-                    }
-                    else if (type == GamePacket::MASTER_HEARTBEAT) {
-                        MasterHeartbeatPacket pkt; des.object(pkt);
-                        if (des.adapter().error() == bitsery::ReaderError::NoError) {
-                            std::lock_guard<std::mutex> lock(lobbyMutex);
-                            for (auto& pair : lobbies) {
-                                if (pair.second.peerId == peerId) {
-                                    pair.second.currentPlayers = pkt.currentPlayers;
-                                    pair.second.wave = pkt.wave;
-                                    pair.second.lastHeartbeatTime = now;
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                    else if (type == GamePacket::MASTER_LIST_REQ) {
-                        std::lock_guard<std::mutex> lock(lobbyMutex);
-                        MasterListResPacket res;
-                        for (const auto& pair : lobbies) {
-                            LobbyInfo info;
-                            info.id = pair.second.id;
-                            info.name = pair.second.name;
-                            info.ip = pair.second.ip;
-                            info.port = pair.second.port;
-                            info.currentPlayers = pair.second.currentPlayers;
-                            info.maxPlayers = pair.second.maxPlayers;
-                            info.wave = pair.second.wave;
-                            res.lobbies.push_back(info);
-                        }
-                        Buffer resBuf; OutputAdapter resAd(resBuf);
-                        bitsery::Serializer<OutputAdapter> ser(std::move(resAd));
-                        ser.value1b(GamePacket::MASTER_LIST_RES);
-                        ser.object(res);
-                        ser.adapter().flush();
-                        server->send(peerId, DeliveryType::RELIABLE, StreamBuffer::alloc(resBuf.data(), resBuf.size()));
-                    }
-                }
-            }
+        for (const auto& name : registry.Expire(now)) {
+            std::cout << "Lobby timed out: " << name << "\n";
         }
-
-        static double lastCleanup = 0;
-        if (now - lastCleanup > 5.0) {
-            lastCleanup = now;
-            std::lock_guard<std::mutex> lock(lobbyMutex);
-            for (auto it = lobbies.begin(); it != lobbies.end(); ) {
-                if (now - it->second.lastHeartbeatTime > 30.0) {
-                    std::cout << "Lobby timed out: " << it->second.name << "\n";
-                    it = lobbies.erase(it);
-                }
-                else {
-                    ++it;
-                }
+        if (now - lastSnapshot >= SNAPSHOT_INTERVAL && registry.Version() != savedVersion) {
+            lastSnapshot = now;
+            savedVersion = registry.Version();
+            if (!registry.SaveSnapshot(snapshotPath, (uint64_t)std::time(nullptr))) {
+                std::cout << "MASTER SERVER: Failed to write snapshot " << snapshotPath << "\n";
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::this_thread::sleep_for(std::chrono::milliseconds(250));
     }
 
+    std::cout << "MASTER SERVER: Stopping..." << std::endl;
+    for (auto& shard : shards) shard->Stop();
+    if (registry.Version() != savedVersion && !registry.SaveSnapshot(snapshotPath, (uint64_t)std::time(nullptr))) {
+        std::cout << "MASTER SERVER: Failed to write snapshot " << snapshotPath << "\n";
+    }
     enet_deinitialize();
     return 0;
-}
\ No newline at end of file
+}
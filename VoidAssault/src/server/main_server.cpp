@@ -20,10 +20,7 @@ int main() {
         return 1;
     }
 
-#ifdef WIN32
-    InitWindow(100, 100, "ServerHeadless");
-    SetWindowState(FLAG_WINDOW_HIDDEN);
-#else
+#ifndef WIN32
     signal(SIGINT, SignalHandler);
     signal(SIGTERM, SignalHandler);
 #endif